@@ -0,0 +1,118 @@
+// Единая программа замеров для ядер лабораторных работ.
+// Заголовки лабораторных объявляют ядра в своих пространствах имён (lab2_1, lab2_2, ...),
+// так как имена функций и глобальных переменных в разных работах совпадают.
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+#include <omp.h>
+#include "../common/bench.h"
+#include "../lab2/2.1/matrix_vector.h"
+#include "../lab2/2.2/integrate.h"
+#include "../lab2/2.2/quadrature.h"
+#include "../lab2/2.3/simple_iteration.h"
+#include "../lab3/task1/matrix_vector.h"
+#include "../lab3/task2/server.h"
+
+// Произведение матрицы на вектор из lab2/2.1 (OpenMP); размер - сторона квадратной матрицы
+static bench::timed_func gemv_omp(long long size, int threads) {
+    auto a = std::make_shared<std::vector<double>>(size * size);
+    auto b = std::make_shared<std::vector<double>>(size);
+    auto c = std::make_shared<std::vector<double>>(size);
+    #pragma omp parallel for num_threads(threads)
+    for (long long i = 0; i < size; i++)
+        for (long long j = 0; j < size; j++)
+            (*a)[i * size + j] = i + j;
+    for (long long j = 0; j < size; j++)
+        (*b)[j] = j;
+    return [a, b, c, threads] {
+        lab2_1::thread_number = threads;
+        lab2_1::matrix_vector_product_omp(*a, *b, *c);
+    };
+}
+
+// Произведение матрицы на вектор из lab3/task1 (std::thread, инициализация и произведение)
+static bench::timed_func gemv_threads(long long size, int threads) {
+    auto a = std::make_shared<std::vector<double>>(size * size);
+    auto b = std::make_shared<std::vector<double>>(size);
+    auto c = std::make_shared<std::vector<double>>(size);
+    return [a, b, c, size, threads] {
+        lab3_1::parallelize_task(lab3_1::matrix_vector_init, *a, *b, *c, size, size, threads);
+        lab3_1::parallelize_task(lab3_1::matrix_vector_product, *a, *b, *c, size, size, threads);
+    };
+}
+
+// Система Ax = b из lab2/2.3 (A - 2 на диагонали и 1 вне её); размер - порядок системы
+struct linear_system {
+    std::vector<double> A, b, x;
+    explicit linear_system(long long n) : A(n * n), b(n, n + 1.0), x(n, 0.0) {
+        for (long long i = 0; i < n; i++)
+            for (long long j = 0; j < n; j++)
+                A[i * n + j] = i == j ? 2.0 : 1.0;
+    }
+};
+
+template <void (*Method)(double*, double*, double*, int)>
+static bench::timed_func simple_iteration(long long size, int threads) {
+    auto system = std::make_shared<linear_system>(size);
+    return [system, size, threads] {
+        lab2_3::threads_number = threads;
+        std::fill(system->x.begin(), system->x.end(), 0.0);
+        Method(system->A.data(), system->x.data(), system->b.data(), size);
+    };
+}
+
+// Пропускная способность сервера задач из lab3/task2: size задач SinTask отправляются сразу,
+// затем забираются их результаты; потоки - число рабочих потоков сервера
+static bench::timed_func server_throughput(long long size, int threads) {
+    auto server = std::make_shared<lab3_2::Server<float>>();
+    auto task = std::make_shared<lab3_2::SinTask<float>>(3.14f / 6);
+    server->start(threads);
+    return [server, task, size] {
+        std::vector<size_t> task_ids(size);
+        for (long long i = 0; i < size; i++)
+            task_ids[i] = server->add_task(task.get());
+        for (size_t task_id : task_ids)
+            server->request_result(task_id);
+    };
+}
+
+int main(int argc, char** argv) {
+    bench::add("lab2.1/gemv_serial", {20000, 40000}, [](long long size, int) {
+        auto a = std::make_shared<std::vector<double>>(size * size, 1.0);
+        auto b = std::make_shared<std::vector<double>>(size, 1.0);
+        auto c = std::make_shared<std::vector<double>>(size);
+        return bench::timed_func([a, b, c] { lab2_1::matrix_vector_product(*a, *b, *c); });
+    }, false);
+    bench::add("lab2.1/gemv_omp", {20000, 40000}, gemv_omp);
+
+    bench::add("lab2.2/integrate_serial", {40000000}, [](long long size, int) {
+        return bench::timed_func([size] { lab2_2::integrate(lab2_2::func, -4.0, 4.0, size); });
+    }, false);
+    bench::add("lab2.2/integrate_omp", {40000000}, [](long long size, int threads) {
+        return bench::timed_func([size, threads] {
+            lab2_2::thread_limit = threads;
+            lab2_2::integrate_omp(lab2_2::func, -4.0, 4.0, size);
+        });
+    });
+    bench::add("lab2.2/integrate_batch", {40000000}, [](long long size, int threads) {
+        return bench::timed_func([size, threads] { lab2_2::integrate_batch(lab2_2::gauss_batch, -4.0, 4.0, size, threads); });
+    });
+    // Для адаптивного метода размер задаёт допуск 10^-size, поэтому общий --sizes к нему не применяется
+    bench::add("lab2.2/integrate_gk", {13}, [](long long size, int threads) {
+        return bench::timed_func([size, threads] { lab2_2::integrate_gk(lab2_2::gauss_batch, -4.0, 4.0, std::pow(10.0, -size), threads); });
+    }, true, true);
+
+    bench::add("lab2.3/first_serial", {2000}, simple_iteration<lab2_3::simple_iteration_method_first_realization_serial>, false);
+    bench::add("lab2.3/first_parallel", {2000}, simple_iteration<lab2_3::simple_iteration_method_first_realization_parallel>);
+    bench::add("lab2.3/second_parallel", {2000}, simple_iteration<lab2_3::simple_iteration_method_second_realization>);
+
+    bench::add("lab3.task1/gemv_threads", {20000, 40000}, gemv_threads);
+
+    bench::add("lab3.task2/server_throughput", {100000}, server_throughput);
+
+    return bench::main(argc, argv);
+}
@@ -0,0 +1,213 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ * Автонастройка параметров параллельных ядер под конкретную машину.
+ * Перебираются число потоков, расписание OpenMP и его chunk, размер блока строк и ширина
+ * плитки столбцов. Полный перебор слишком долог, поэтому используется покоординатный спуск:
+ * начиная с параметров по умолчанию, по очереди для каждого параметра выбирается лучшее
+ * значение при остальных фиксированных, и так несколько проходов.
+ *
+ * Лучшая конфигурация сохраняется в локальный файл (AUTOTUNE_CACHE или ./autotune.cache)
+ * с ключом "ядро, класс размера задачи, имя машины, число процессоров"; класс размера -
+ * округлённый log2 размера. Следующие запуски берут конфигурацию из файла без перебора.
+ * Заголовок подключается и из C, и из C++, в том числе без OpenMP (тогда расписание не перебирается).
+ *
+ * Ядро получает конфигурацию через функцию запуска и само применяет её: задаёт число потоков,
+ * вызывает omp_set_schedule перед циклом со schedule(runtime), делит строки на блоки.
+ */
+
+typedef struct {
+    int threads;
+    int schedule; /* omp_sched_t: omp_sched_static, omp_sched_dynamic, omp_sched_guided */
+    int chunk; /* 0 - chunk по умолчанию */
+    int row_block; /* 0 - ядро делит строки поровну */
+    int tile; /* 0 - без деления на плитки */
+} tune_config;
+
+/* Кандидаты для каждого параметра; count == 0 - параметр не настраивается */
+#define TUNE_MAX_CANDIDATES 16
+typedef struct {
+    int values[TUNE_MAX_CANDIDATES];
+    int count;
+} tune_candidates;
+
+typedef struct {
+    tune_candidates threads; /* count == 0 - степени двойки до числа процессоров и само это число */
+    tune_candidates schedule;
+    tune_candidates chunk;
+    tune_candidates row_block;
+    tune_candidates tile;
+    int repetitions; /* Замеров на конфигурацию, берётся минимум */
+    int passes; /* Проходов покоординатного спуска */
+} tune_space;
+
+/* Запуск ядра с конфигурацией cfg; ctx - данные задачи */
+typedef void (*tune_run_func)(const tune_config* cfg, void* ctx);
+
+static inline double tune_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1.e-9;
+}
+
+static inline int tune_num_procs(void)
+{
+#ifdef _OPENMP
+    return omp_get_num_procs();
+#else
+    return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+static inline const char* tune_cache_path(void)
+{
+    const char* path = getenv("AUTOTUNE_CACHE");
+    return path ? path : "autotune.cache";
+}
+
+static inline void tune_key(char* key, size_t key_size, const char* kernel, long long size)
+{
+    char host[64] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    int size_class = size > 0 ? (int)lround(log2((double)size)) : 0;
+    snprintf(key, key_size, "%s:%d:%s:%d", kernel, size_class, host, tune_num_procs());
+}
+
+/* Конфигурация из файла; последняя запись с тем же ключом главнее. Возвращает 1, если найдена */
+static inline int tune_lookup(const char* kernel, long long size, tune_config* cfg)
+{
+    char key[256], line[512], line_key[256];
+    tune_config found;
+    int ok = 0;
+    tune_key(key, sizeof(key), kernel, size);
+    FILE* file = fopen(tune_cache_path(), "r");
+    if (!file)
+        return 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%255s %d %d %d %d %d", line_key, &found.threads, &found.schedule, &found.chunk, &found.row_block, &found.tile) == 6
+            && strcmp(line_key, key) == 0) {
+            *cfg = found;
+            ok = 1;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+static inline void tune_store(const char* kernel, long long size, const tune_config* cfg, double seconds)
+{
+    char key[256];
+    tune_key(key, sizeof(key), kernel, size);
+    FILE* file = fopen(tune_cache_path(), "a");
+    if (!file)
+        return;
+    fprintf(file, "%s %d %d %d %d %d %.9f\n", key, cfg->threads, cfg->schedule, cfg->chunk, cfg->row_block, cfg->tile, seconds);
+    fclose(file);
+}
+
+static inline double tune_measure(const tune_config* cfg, tune_run_func run, void* ctx, int repetitions)
+{
+    double best = INFINITY;
+    for (int r = 0; r < repetitions; r++) {
+        double t = tune_seconds();
+        run(cfg, ctx);
+        t = tune_seconds() - t;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+/* Покоординатный спуск по одному параметру: field указывает на поле cfg */
+static inline double tune_coordinate(tune_config* cfg, int* field, const tune_candidates* candidates, double best_time,
+                                     tune_run_func run, void* ctx, int repetitions)
+{
+    int best_value = *field;
+    for (int i = 0; i < candidates->count; i++) {
+        if (candidates->values[i] == best_value)
+            continue;
+        *field = candidates->values[i];
+        double t = tune_measure(cfg, run, ctx, repetitions);
+        if (t < best_time) {
+            best_time = t;
+            best_value = *field;
+        }
+    }
+    *field = best_value;
+    return best_time;
+}
+
+/* Пространство поиска по умолчанию: потоки, а с OpenMP - ещё три расписания и несколько значений chunk */
+static inline tune_space tune_default_space(void)
+{
+    tune_space space;
+    memset(&space, 0, sizeof(space));
+#ifdef _OPENMP
+    static const int schedules[] = { omp_sched_static, omp_sched_dynamic, omp_sched_guided };
+    static const int chunks[] = { 0, 1, 8, 40, 256 };
+    memcpy(space.schedule.values, schedules, sizeof(schedules));
+    space.schedule.count = 3;
+    memcpy(space.chunk.values, chunks, sizeof(chunks));
+    space.chunk.count = 5;
+#endif
+    space.repetitions = 2;
+    space.passes = 2;
+    return space;
+}
+
+/*
+ * Настроенная конфигурация ядра kernel для задачи размера size: из файла, если она там есть,
+ * иначе поиском от начальной конфигурации initial с сохранением результата.
+ */
+static inline tune_config autotune(const char* kernel, long long size, tune_space space, tune_config initial,
+                                   tune_run_func run, void* ctx)
+{
+    tune_config cfg = initial;
+    if (tune_lookup(kernel, size, &cfg))
+        return cfg;
+
+    if (space.threads.count == 0) {
+        int procs = tune_num_procs();
+        for (int t = 1; t < procs && space.threads.count < TUNE_MAX_CANDIDATES - 1; t *= 2)
+            space.threads.values[space.threads.count++] = t;
+        space.threads.values[space.threads.count++] = procs;
+    }
+    if (space.repetitions < 1)
+        space.repetitions = 1;
+
+    /* Прогрев, затем замер начальной конфигурации */
+    run(&cfg, ctx);
+    double best_time = tune_measure(&cfg, run, ctx, space.repetitions);
+    for (int pass = 0; pass < space.passes; pass++) {
+        best_time = tune_coordinate(&cfg, &cfg.threads, &space.threads, best_time, run, ctx, space.repetitions);
+        best_time = tune_coordinate(&cfg, &cfg.schedule, &space.schedule, best_time, run, ctx, space.repetitions);
+        best_time = tune_coordinate(&cfg, &cfg.chunk, &space.chunk, best_time, run, ctx, space.repetitions);
+        best_time = tune_coordinate(&cfg, &cfg.row_block, &space.row_block, best_time, run, ctx, space.repetitions);
+        best_time = tune_coordinate(&cfg, &cfg.tile, &space.tile, best_time, run, ctx, space.repetitions);
+    }
+    tune_store(kernel, size, &cfg, best_time);
+    return cfg;
+}
+
+static inline void tune_print(const char* kernel, const tune_config* cfg)
+{
+    /* Значения omp_sched_t: 1 - static, 2 - dynamic, 3 - guided, 4 - auto */
+    static const char* names[] = { "-", "static", "dynamic", "guided", "auto" };
+    int kind = cfg->schedule & 0x7;
+    printf("%s tuned: threads %d, schedule %s, chunk %d, row block %d, tile %d\n",
+           kernel, cfg->threads, kind <= 4 ? names[kind] : "?", cfg->chunk, cfg->row_block, cfg->tile);
+}
+
+#endif
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Общая библиотека замеров: регистрация ядер, прогрев, повторения, медиана с доверительным
+// интервалом, перебор числа потоков и размеров задачи из командной строки, вывод в text/json/csv.
+//
+// Ядро регистрируется фабрикой: для пары (размер, потоки) она готовит данные (это не замеряется)
+// и возвращает функцию, время выполнения которой и измеряется.
+
+namespace bench {
+
+using timed_func = std::function<void()>;
+using kernel_factory = std::function<timed_func(long long size, int threads)>;
+
+struct kernel {
+    std::string name;
+    std::vector<long long> default_sizes; // Размеры, если --sizes не задан
+    kernel_factory factory;
+    bool threaded; // false - ядро последовательное и запускается только с одним потоком
+    bool fixed_sizes; // true - размер означает не объём данных, и --sizes к ядру не применяется
+};
+
+struct result {
+    std::string kernel;
+    long long size;
+    int threads;
+    std::vector<double> samples; // Время каждого повторения, с
+    double median;
+    double ci_low; // Границы 95% доверительного интервала медианы
+    double ci_high;
+    double mean;
+    double stddev;
+    double speedup; // Относительно того же ядра и размера с первым числом потоков из перебора
+};
+
+struct config {
+    std::vector<int> threads = {1, 2, 4, 7, 8, 16, 20, 40};
+    std::vector<long long> sizes; // Пусто - у каждого ядра свои размеры по умолчанию
+    int warmup = 1;
+    int repetitions = 5;
+    std::string format = "text";
+    std::string output; // Пусто - стандартный вывод
+    std::string filter; // Подстрока имени ядра
+};
+
+inline std::vector<kernel>& registry() {
+    static std::vector<kernel> kernels;
+    return kernels;
+}
+
+inline void add(std::string name, std::vector<long long> default_sizes, kernel_factory factory, bool threaded = true,
+                bool fixed_sizes = false) {
+    registry().push_back({std::move(name), std::move(default_sizes), std::move(factory), threaded, fixed_sizes});
+}
+
+// Медиана и непараметрический 95% доверительный интервал для неё по порядковым статистикам:
+// ранги n/2 -+ 1.96*sqrt(n)/2
+inline void summarize(result& r) {
+    std::vector<double> sorted = r.samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    r.median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    double spread = 1.96 * std::sqrt(static_cast<double>(n)) / 2;
+    long long low = static_cast<long long>(std::floor(n / 2.0 - spread));
+    long long high = static_cast<long long>(std::ceil(n / 2.0 + spread));
+    r.ci_low = sorted[std::max(0LL, std::min<long long>(low, n - 1))];
+    r.ci_high = sorted[std::max(0LL, std::min<long long>(high, n - 1))];
+    r.mean = 0;
+    for (double s : sorted)
+        r.mean += s;
+    r.mean /= n;
+    r.stddev = 0;
+    for (double s : sorted)
+        r.stddev += (s - r.mean) * (s - r.mean);
+    r.stddev = n > 1 ? std::sqrt(r.stddev / (n - 1)) : 0;
+}
+
+inline double measure(const timed_func& func) {
+    const auto start{std::chrono::steady_clock::now()};
+    func();
+    const auto end{std::chrono::steady_clock::now()};
+    const std::chrono::duration<double> elapsed_seconds{end - start};
+    return elapsed_seconds.count();
+}
+
+inline std::vector<result> run(const config& cfg) {
+    std::vector<result> results;
+    for (const kernel& k : registry()) {
+        if (!cfg.filter.empty() && k.name.find(cfg.filter) == std::string::npos)
+            continue;
+        const std::vector<long long>& sizes = cfg.sizes.empty() || k.fixed_sizes ? k.default_sizes : cfg.sizes;
+        std::vector<int> threads = k.threaded ? cfg.threads : std::vector<int>{1};
+        for (long long size : sizes) {
+            double base = 0;
+            for (int thread_count : threads) {
+                timed_func func = k.factory(size, thread_count);
+                for (int i = 0; i < cfg.warmup; i++)
+                    func();
+                result r{k.name, size, thread_count};
+                for (int i = 0; i < cfg.repetitions; i++)
+                    r.samples.push_back(measure(func));
+                summarize(r);
+                if (base == 0)
+                    base = r.median;
+                r.speedup = base / r.median;
+                std::cerr << k.name << " size=" << size << " threads=" << thread_count << " median=" << r.median << " s\n";
+                results.push_back(r);
+            }
+        }
+    }
+    return results;
+}
+
+inline void write_text(std::ostream& out, const std::vector<result>& results) {
+    for (const result& r : results) {
+        out << r.kernel << " size=" << r.size << " threads=" << r.threads << ": median " << r.median
+            << " s [" << r.ci_low << ", " << r.ci_high << "], mean " << r.mean << " +- " << r.stddev
+            << ", speedup " << r.speedup << "\n";
+    }
+}
+
+inline void write_csv(std::ostream& out, const std::vector<result>& results) {
+    out << "kernel,size,threads,repetitions,median,ci_low,ci_high,mean,stddev,speedup\n";
+    for (const result& r : results) {
+        out << r.kernel << "," << r.size << "," << r.threads << "," << r.samples.size() << "," << r.median << ","
+            << r.ci_low << "," << r.ci_high << "," << r.mean << "," << r.stddev << "," << r.speedup << "\n";
+    }
+}
+
+inline void write_json(std::ostream& out, const std::vector<result>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const result& r = results[i];
+        out << "  {\"kernel\": \"" << r.kernel << "\", \"size\": " << r.size << ", \"threads\": " << r.threads
+            << ", \"median\": " << r.median << ", \"ci_low\": " << r.ci_low << ", \"ci_high\": " << r.ci_high
+            << ", \"mean\": " << r.mean << ", \"stddev\": " << r.stddev << ", \"speedup\": " << r.speedup << ", \"samples\": [";
+        for (size_t j = 0; j < r.samples.size(); j++)
+            out << (j ? ", " : "") << r.samples[j];
+        out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+inline void write(const config& cfg, const std::vector<result>& results) {
+    std::ofstream file;
+    if (!cfg.output.empty())
+        file.open(cfg.output);
+    std::ostream& out = cfg.output.empty() ? std::cout : file;
+    out.precision(9);
+    if (cfg.format == "json")
+        write_json(out, results);
+    else if (cfg.format == "csv")
+        write_csv(out, results);
+    else
+        write_text(out, results);
+}
+
+template <typename T>
+std::vector<T> parse_list(const std::string& value) {
+    std::vector<T> list;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        list.push_back(static_cast<T>(std::stoll(item)));
+    return list;
+}
+
+inline void print_help(const char* program) {
+    std::cout << program << " [options]\n"
+              << "--threads 1,2,4   thread counts to sweep\n"
+              << "--sizes 1000,2000 problem sizes (default: per kernel; kernels with fixed sizes ignore it)\n"
+              << "--warmup N        warmup runs (default 1)\n"
+              << "--reps N          measured repetitions (default 5)\n"
+              << "--format F        text, json or csv\n"
+              << "--output FILE     write results to file\n"
+              << "--filter S        run kernels whose name contains S\n"
+              << "--list            list registered kernels\n";
+}
+
+// Разбор командной строки и запуск; возвращает код завершения для main
+inline int main(int argc, char** argv) {
+    config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+                throw std::invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--threads")
+            cfg.threads = parse_list<int>(value());
+        else if (arg == "--sizes")
+            cfg.sizes = parse_list<long long>(value());
+        else if (arg == "--warmup")
+            cfg.warmup = std::stoi(value());
+        else if (arg == "--reps")
+            cfg.repetitions = std::max(1, std::stoi(value()));
+        else if (arg == "--format")
+            cfg.format = value();
+        else if (arg == "--output")
+            cfg.output = value();
+        else if (arg == "--filter")
+            cfg.filter = value();
+        else if (arg == "--list") {
+            for (const kernel& k : registry())
+                std::cout << k.name << "\n";
+            return 0;
+        }
+        else {
+            print_help(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+    write(cfg, run(cfg));
+    return 0;
+}
+
+} // namespace bench
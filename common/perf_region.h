@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Профилировщик именованных участков кода на аппаратных счётчиках Linux (perf_event_open).
+// push/pop повторяют интерфейс nvtxRangePushA/nvtxRangePop. Вызванные из последовательного кода,
+// они снимают счётчики со всех потоков команды OpenMP (каждый поток читает свои), поэтому видны
+// и суммарные такты/инструкции/промахи LLC, и дисбаланс нагрузки между потоками.
+// Если ядро не даёт аппаратные счётчики (виртуальная машина, perf_event_paranoid), участок
+// всё равно замеряется по времени, а недоступные величины выводятся как n/a.
+//
+// Для участка можно указать объём работы (add_work): число операций с плавающей точкой и байт,
+// которые алгоритм обязан передать из памяти. Тогда отчёт выводит достигнутые GFLOP/s и GB/s
+// и сравнивает их с крышей (roofline), измеренной на этой машине: пропускная способность памяти -
+// по STREAM triad, пиковая производительность - по независимым цепочкам FMA.
+//
+// По умолчанию профилировщик выключен и push/pop ничего не делают; включается enable().
+
+namespace perf {
+
+enum counter { cycles, instructions, llc_misses, task_clock, counter_count };
+
+using sample = std::array<uint64_t, counter_count>;
+
+// Счётчики одного потока; открываются при первом чтении
+class thread_counters {
+public:
+    thread_counters() {
+        const std::pair<uint32_t, uint64_t> events[counter_count] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        };
+        for (int i = 0; i < counter_count; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // pid = 0, cpu = -1: только вызывающий поток на любом ядре
+            _fd[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+
+    thread_counters(const thread_counters&) = delete;
+    thread_counters& operator=(const thread_counters&) = delete;
+
+    ~thread_counters() {
+        for (int fd : _fd)
+            if (fd >= 0)
+                close(fd);
+    }
+
+    sample read_all() const {
+        sample values{};
+        for (int i = 0; i < counter_count; i++) {
+            uint64_t value = 0;
+            if (_fd[i] >= 0 && ::read(_fd[i], &value, sizeof(value)) == sizeof(value))
+                values[i] = value;
+        }
+        return values;
+    }
+
+    bool available(counter c) const { return _fd[c] >= 0; }
+
+    static thread_counters& current() {
+        static thread_local thread_counters counters;
+        return counters;
+    }
+
+private:
+    int _fd[counter_count];
+};
+
+struct roofline {
+    double bandwidth_gbs{0}; // STREAM triad, ГБ/с
+    double peak_gflops{0}; // Независимые FMA во всех потоках, GFLOP/s
+};
+
+// Пропускная способность памяти по STREAM triad: a[i] = b[i] + s * c[i], 24 байта на элемент
+inline double measure_stream_triad(size_t n = size_t(1) << 23, int repetitions = 5) {
+    std::vector<double> a(n), b(n), c(n);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        a[i] = 0;
+        b[i] = 1;
+        c[i] = 2;
+    }
+    double best = 0;
+    for (int r = 0; r < repetitions; r++) {
+        const auto start{std::chrono::steady_clock::now()};
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++)
+            a[i] = b[i] + 3.0 * c[i];
+        const auto end{std::chrono::steady_clock::now()};
+        const std::chrono::duration<double> elapsed_seconds{end - start};
+        best = std::max(best, 3.0 * sizeof(double) * n / elapsed_seconds.count() * 1e-9);
+    }
+    return best;
+}
+
+// Пиковая производительность: в каждом потоке 32 независимые цепочки x = x * m + a (2 FLOP)
+inline double measure_peak_flops(long long iterations = 1 << 22) {
+    constexpr int chains = 32;
+    double seconds = 0;
+    double total_flops = 0;
+    double sink = 0;
+    const auto start{std::chrono::steady_clock::now()};
+    #pragma omp parallel reduction(+:total_flops, sink)
+    {
+        double x[chains];
+        for (int k = 0; k < chains; k++)
+            x[k] = 1.0 + k * 1e-3;
+        for (long long i = 0; i < iterations; i++) {
+            #pragma omp simd
+            for (int k = 0; k < chains; k++)
+                x[k] = x[k] * 0.999999 + 1e-6;
+        }
+        for (int k = 0; k < chains; k++)
+            sink += x[k];
+        total_flops += 2.0 * chains * iterations;
+    }
+    const auto end{std::chrono::steady_clock::now()};
+    const std::chrono::duration<double> elapsed_seconds{end - start};
+    seconds = elapsed_seconds.count();
+    // sink не даёт компилятору выбросить цикл
+    return sink == 0 ? 0 : total_flops / seconds * 1e-9;
+}
+
+inline roofline measure_roofline() {
+    roofline r;
+    r.bandwidth_gbs = measure_stream_triad();
+    r.peak_gflops = measure_peak_flops();
+    return r;
+}
+
+class profiler {
+public:
+    static profiler& instance() {
+        static profiler p;
+        return p;
+    }
+
+    void enable(bool enabled = true) { _enabled = enabled; }
+
+    bool enabled() const { return _enabled; }
+
+    void push(const char* name) {
+        if (!_enabled)
+            return;
+        // Счётчики снимаются до отметки времени, а в pop - после, чтобы сам снимок не попадал в участок
+        std::vector<sample> values = snapshot();
+        _stack.push_back({name, std::chrono::steady_clock::now(), std::move(values)});
+    }
+
+    void pop() {
+        if (!_enabled || _stack.empty())
+            return;
+        const auto end{std::chrono::steady_clock::now()};
+        std::vector<sample> end_values = snapshot();
+        open_region& open = _stack.back();
+        region& r = _regions[open.name];
+        const std::chrono::duration<double> elapsed_seconds{end - open.start};
+        r.calls++;
+        r.seconds += elapsed_seconds.count();
+        if (r.per_thread.size() < end_values.size())
+            r.per_thread.resize(end_values.size(), sample{});
+        for (size_t t = 0; t < end_values.size() && t < open.values.size(); t++)
+            for (int c = 0; c < counter_count; c++)
+                r.per_thread[t][c] += end_values[t][c] - open.values[t][c];
+        _stack.pop_back();
+    }
+
+    // Объём работы, выполненной участком name (суммируется по вызовам)
+    void add_work(const char* name, double flops, double bytes) {
+        if (!_enabled)
+            return;
+        region& r = _regions[name];
+        r.flops += flops;
+        r.bytes += bytes;
+    }
+
+    void report(std::ostream& out, bool with_roofline = true) {
+        if (!_enabled || _regions.empty())
+            return;
+        const thread_counters& counters = thread_counters::current();
+        roofline roof;
+        if (with_roofline) {
+            roof = measure_roofline();
+            out << "roofline: memory " << roof.bandwidth_gbs << " GB/s (STREAM triad), peak " << roof.peak_gflops << " GFLOP/s\n";
+        }
+        auto value = [&](bool available, double v) {
+            std::ostringstream s;
+            if (available)
+                s << v;
+            else
+                s << "n/a";
+            return s.str();
+        };
+        for (const auto& entry : _regions) {
+            const region& r = entry.second;
+            sample total{};
+            uint64_t min_cycles = UINT64_MAX, max_cycles = 0;
+            for (const sample& s : r.per_thread) {
+                for (int c = 0; c < counter_count; c++)
+                    total[c] += s[c];
+                min_cycles = std::min(min_cycles, s[cycles]);
+                max_cycles = std::max(max_cycles, s[cycles]);
+            }
+            bool hw = counters.available(cycles);
+            out << entry.first << ": calls " << r.calls << ", time " << r.seconds << " s"
+                << ", threads " << r.per_thread.size()
+                << ", cpu time " << value(counters.available(task_clock), total[task_clock] * 1e-9) << " s"
+                << ", cycles " << value(hw, total[cycles])
+                << ", IPC " << value(hw && counters.available(instructions) && total[cycles], double(total[instructions]) / std::max<uint64_t>(total[cycles], 1))
+                << ", LLC misses " << value(counters.available(llc_misses), total[llc_misses])
+                << ", LLC traffic " << value(counters.available(llc_misses), total[llc_misses] * 64.0 / r.seconds * 1e-9) << " GB/s"
+                << ", thread cycles max/min " << value(hw && min_cycles, double(max_cycles) / std::max<uint64_t>(min_cycles, 1)) << "\n";
+            if (r.flops > 0 || r.bytes > 0) {
+                double gflops = r.flops / r.seconds * 1e-9;
+                double gbs = r.bytes / r.seconds * 1e-9;
+                out << "    achieved " << gflops << " GFLOP/s, " << gbs << " GB/s";
+                if (with_roofline && r.flops > 0 && r.bytes > 0) {
+                    double intensity = r.flops / r.bytes;
+                    double bound = std::min(roof.peak_gflops, intensity * roof.bandwidth_gbs);
+                    out << "; intensity " << intensity << " FLOP/byte, roofline bound " << bound << " GFLOP/s ("
+                        << (intensity * roof.bandwidth_gbs < roof.peak_gflops ? "memory" : "compute") << " bound), "
+                        << std::setprecision(3) << 100.0 * gflops / bound << "% of bound, "
+                        << 100.0 * gbs / roof.bandwidth_gbs << "% of bandwidth" << std::setprecision(6);
+                }
+                else if (with_roofline && r.bytes > 0) {
+                    out << "; " << std::setprecision(3) << 100.0 * gbs / roof.bandwidth_gbs << "% of bandwidth" << std::setprecision(6);
+                }
+                out << "\n";
+            }
+        }
+    }
+
+private:
+    struct region {
+        long long calls{0};
+        double seconds{0};
+        double flops{0};
+        double bytes{0};
+        std::vector<sample> per_thread; // Сумма приращений счётчиков по номеру потока OpenMP
+    };
+
+    struct open_region {
+        std::string name;
+        std::chrono::steady_clock::time_point start;
+        std::vector<sample> values;
+    };
+
+    // Значения счётчиков всех потоков команды (или только текущего потока внутри параллельной области)
+    static std::vector<sample> snapshot() {
+        if (omp_in_parallel())
+            return {thread_counters::current().read_all()};
+        std::vector<sample> values(omp_get_max_threads());
+        #pragma omp parallel num_threads(values.size())
+        values[omp_get_thread_num()] = thread_counters::current().read_all();
+        return values;
+    }
+
+    bool _enabled{false};
+    std::vector<open_region> _stack;
+    std::map<std::string, region> _regions;
+};
+
+inline void enable(bool enabled = true) { profiler::instance().enable(enabled); }
+
+inline void push(const char* name) { profiler::instance().push(name); }
+
+inline void pop() { profiler::instance().pop(); }
+
+inline void add_work(const char* name, double flops, double bytes) { profiler::instance().add_work(name, flops, bytes); }
+
+inline void report(std::ostream& out = std::cout) { profiler::instance().report(out); }
+
+// Участок на время жизни объекта
+class scoped_region {
+public:
+    explicit scoped_region(const char* name) { push(name); }
+    ~scoped_region() { pop(); }
+    scoped_region(const scoped_region&) = delete;
+    scoped_region& operator=(const scoped_region&) = delete;
+};
+
+} // namespace perf
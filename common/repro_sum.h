@@ -0,0 +1,203 @@
+#ifndef REPRO_SUM_H
+#define REPRO_SUM_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/*
+ * Воспроизводимое суммирование, не зависящее от числа потоков.
+ * Данные делятся на блоки фиксированного размера REPRO_BLOCK (не на куски по числу потоков),
+ * каждый блок суммируется последовательно с компенсацией Кэхэна, а частичные суммы блоков
+ * складываются по фиксированному попарному дереву. Порядок всех сложений определяется только
+ * длиной данных, поэтому результат побитово совпадает при любом числе потоков и расписании.
+ *
+ * Заголовок подключается и из C, и из C++. Функции *_omp содержат orphaned "omp for":
+ * вызванные внутри параллельной области, они делят блоки между потоками команды и возвращают
+ * одинаковый результат всем потокам; вызванные вне её, выполняются одним потоком.
+ * Буфер partials читается всеми потоками после неявного барьера, поэтому повторно использовать
+ * его внутри той же параллельной области можно только после следующего барьера.
+ * Компенсация Кэхэна не переживает -ffast-math: с ним компилятор вправе её сократить.
+ */
+
+#define REPRO_BLOCK 4096
+
+/* Компенсированный сумматор Кэхэна */
+typedef struct {
+    double sum;
+    double c;
+} repro_acc;
+
+static inline void repro_acc_init(repro_acc* acc)
+{
+    acc->sum = 0.0;
+    acc->c = 0.0;
+}
+
+static inline void repro_acc_add(repro_acc* acc, double value)
+{
+    double y = value - acc->c;
+    double t = acc->sum + y;
+    acc->c = (t - acc->sum) - y;
+    acc->sum = t;
+}
+
+static inline double repro_acc_value(const repro_acc* acc)
+{
+    return acc->sum - acc->c;
+}
+
+/* Количество блоков для n элементов и границы блока b */
+static inline size_t repro_block_count(size_t n)
+{
+    return (n + REPRO_BLOCK - 1) / REPRO_BLOCK;
+}
+
+static inline size_t repro_block_begin(size_t b)
+{
+    return b * REPRO_BLOCK;
+}
+
+static inline size_t repro_block_end(size_t b, size_t n)
+{
+    size_t end = (b + 1) * REPRO_BLOCK;
+    return end < n ? end : n;
+}
+
+/* Сумма двух пар (сумма, поправка) без потери младших разрядов старших частей (TwoSum) */
+static inline repro_acc repro_acc_merge(repro_acc left, repro_acc right)
+{
+    repro_acc result;
+    double s = left.sum + right.sum;
+    double bb = s - left.sum;
+    double e = (left.sum - (s - bb)) + (right.sum - bb);
+    result.sum = s;
+    result.c = left.c + right.c - e;
+    return result;
+}
+
+static inline repro_acc repro_tree_acc(const double* partials, size_t n)
+{
+    repro_acc acc;
+    repro_acc_init(&acc);
+    if (n == 1)
+        acc.sum = partials[0];
+    if (n <= 1)
+        return acc;
+    size_t half = n / 2;
+    return repro_acc_merge(repro_tree_acc(partials, half), repro_tree_acc(partials + half, n - half));
+}
+
+/* Сумма частичных сумм по фиксированному попарному дереву с компенсацией в каждом узле */
+static inline double repro_tree_sum(const double* partials, size_t n)
+{
+    repro_acc acc = repro_tree_acc(partials, n);
+    return repro_acc_value(&acc);
+}
+
+/* Сумма короткого массива (например, блока значений, посчитанных пакетно): REPRO_LANES
+ * независимых сумматоров Кэхэна с фиксированным распределением элементов по ним, поэтому
+ * цикл векторизуется, а порядок сложений по-прежнему зависит только от n */
+#define REPRO_LANES 8
+
+static inline double repro_sum_lanes(const double* x, size_t n)
+{
+    double sum[REPRO_LANES] = { 0 };
+    double c[REPRO_LANES] = { 0 };
+    size_t full = n / REPRO_LANES * REPRO_LANES;
+    for (size_t i = 0; i < full; i += REPRO_LANES) {
+        #pragma omp simd
+        for (int l = 0; l < REPRO_LANES; l++) {
+            double y = x[i + l] - c[l];
+            double t = sum[l] + y;
+            c[l] = (t - sum[l]) - y;
+            sum[l] = t;
+        }
+    }
+    repro_acc acc;
+    repro_acc_init(&acc);
+    for (int l = 0; l < REPRO_LANES; l++) {
+        repro_acc lane;
+        lane.sum = sum[l];
+        lane.c = c[l];
+        acc = repro_acc_merge(acc, lane);
+    }
+    for (size_t i = full; i < n; i++)
+        repro_acc_add(&acc, x[i]);
+    return repro_acc_value(&acc);
+}
+
+/* Сумма элементов x; partials - буфер на repro_block_count(n) значений */
+static inline double repro_sum_omp(const double* x, size_t n, double* partials)
+{
+    size_t blocks = repro_block_count(n);
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+        repro_acc acc;
+        repro_acc_init(&acc);
+        for (size_t i = repro_block_begin(b); i < repro_block_end(b, n); i++)
+            repro_acc_add(&acc, x[i]);
+        partials[b] = repro_acc_value(&acc);
+    }
+    return repro_tree_sum(partials, blocks);
+}
+
+/* Сумма квадратов элементов x; partials - буфер на repro_block_count(n) значений */
+static inline double repro_sum_squares_omp(const double* x, size_t n, double* partials)
+{
+    size_t blocks = repro_block_count(n);
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+        repro_acc acc;
+        repro_acc_init(&acc);
+        for (size_t i = repro_block_begin(b); i < repro_block_end(b, n); i++)
+            repro_acc_add(&acc, x[i] * x[i]);
+        partials[b] = repro_acc_value(&acc);
+    }
+    return repro_tree_sum(partials, blocks);
+}
+
+/* Сумма элементов массива float (накопление в double) */
+static inline double repro_sumf_omp(const float* x, size_t n, double* partials)
+{
+    size_t blocks = repro_block_count(n);
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+        repro_acc acc;
+        repro_acc_init(&acc);
+        for (size_t i = repro_block_begin(b); i < repro_block_end(b, n); i++)
+            repro_acc_add(&acc, x[i]);
+        partials[b] = repro_acc_value(&acc);
+    }
+    return repro_tree_sum(partials, blocks);
+}
+
+/* Варианты с собственным буфером для вызова вне параллельных областей */
+static inline double repro_sum(const double* x, size_t n)
+{
+    double* partials = (double*)malloc(sizeof(double) * (repro_block_count(n) + 1));
+    double sum = 0.0;
+    #pragma omp parallel
+    {
+        double local = repro_sum_omp(x, n, partials);
+        #pragma omp master
+        sum = local;
+    }
+    free(partials);
+    return sum;
+}
+
+static inline double repro_sumf(const float* x, size_t n)
+{
+    double* partials = (double*)malloc(sizeof(double) * (repro_block_count(n) + 1));
+    double sum = 0.0;
+    #pragma omp parallel
+    {
+        double local = repro_sumf_omp(x, n, partials);
+        #pragma omp master
+        sum = local;
+    }
+    free(partials);
+    return sum;
+}
+
+#endif
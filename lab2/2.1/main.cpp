@@ -1,35 +1,32 @@
 #include <iostream>
 #include <omp.h>
 #include <chrono>
+#include <string>
 #include <vector>
+#include "matrix_vector.h"
+#include "../../common/autotune.h"
 
-int thread_number = 0;
+using namespace lab2_1;
 
-// Функция для вычисления произведения матрицы на вектор (в линейном режиме)
-void matrix_vector_product(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c)
+struct tune_data {
+    std::vector<double> a, b, c;
+};
+
+// Параметры параллельной версии из конфигурации автонастройки
+void apply_config(const tune_config* cfg)
 {
-    // Перебираем строки матрицы
-    for (int i = 0; i < c.size(); i++) {
-        c[i] = 0.0; // Инициализируем элемент результирующего вектора нулем
-        // Перебираем столбцы матрицы
-        for (int j = 0; j < b.size(); j++)
-            c[i] += a[i * b.size() + j] * b[j];
-    }   
+    thread_number = cfg->threads;
+    schedule_kind = cfg->schedule;
+    schedule_chunk = cfg->chunk;
+    row_block = cfg->row_block;
+    column_tile = cfg->tile;
 }
-// Функция для вычисления произведения матрицы на вектор (в параллельном режиме)
-void matrix_vector_product_omp(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c)
+
+void run_tuned(const tune_config* cfg, void* ctx)
 {
-    // Определение параллельной секции с указанием числа потоков
-    #pragma omp parallel num_threads(thread_number)
-    {
-        // Директива для распараллеливания цикла
-        #pragma omp for
-        for (int i = 0; i < c.size(); i++) {
-            c[i] = 0.0;
-            for (int j = 0; j < b.size(); j++)
-                c[i] += a[i * b.size() + j] * b[j];
-        }
-    }
+    tune_data* data = static_cast<tune_data*>(ctx);
+    apply_config(cfg);
+    matrix_vector_product_omp(data->a, data->b, data->c);
 }
 
 double run_tests(int m, int n, void (*func)(std::vector<double>&, std::vector<double>&, std::vector<double>&))
@@ -100,6 +97,29 @@ int main(int argc, char* argv[])
             std::cout << "Speedup: " << serial_time / parallel_time << "\n";
         }
     }
+    else if (std::string(argv[3]) == "auto") {
+        // Параметры берутся из autotune.cache, при первом запуске на этой машине - подбираются
+        m = std::stoi(argv[1]);
+        n = std::stoi(argv[2]);
+        tune_data data{std::vector<double>(size_t(m) * n, 1.0), std::vector<double>(n, 1.0), std::vector<double>(m)};
+        tune_space space = tune_default_space();
+        int row_blocks[] = { 0, 4, 16, 64 };
+        int tiles[] = { 0, 2048, 8192 };
+        std::copy(row_blocks, row_blocks + 4, space.row_block.values);
+        space.row_block.count = 4;
+        std::copy(tiles, tiles + 3, space.tile.values);
+        space.tile.count = 3;
+        tune_config initial = { omp_get_num_procs(), omp_sched_static, 0, 0, 0 };
+        tune_config cfg = autotune("lab2.1/gemv_omp", (long long)m * n, space, initial, run_tuned, &data);
+        tune_print("lab2.1/gemv_omp", &cfg);
+        std::cout << "Matrix-vector product (c[m] = a[m, n] * b[n]; m = " << m << ", n = " << n << ")\n";
+        double serial_time = run_tests(m, n, matrix_vector_product);
+        std::cout << "Elapsed time(serial realization): " << serial_time << "sec.\n";
+        apply_config(&cfg);
+        double parallel_time = run_tests(m, n, matrix_vector_product_omp);
+        std::cout << "Elapsed time(tuned parallel realization): " << parallel_time << "sec.\n";
+        std::cout << "Speedup: " << serial_time / parallel_time << "\n";
+    }
     else {
         m = std::stoi(argv[1]);
         n = std::stoi(argv[2]);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+namespace lab2_1 {
+
+static int thread_number = 0; // Число потоков параллельной версии
+static int schedule_kind = omp_sched_static; // Расписание параллельного цикла (omp_sched_t)
+static int schedule_chunk = 0; // chunk расписания, 0 - по умолчанию
+static int row_block = 0; // Строк в одной итерации параллельного цикла, 0 - одна строка
+static int column_tile = 0; // Ширина плитки столбцов, 0 - вся строка
+
+// Функция для вычисления произведения матрицы на вектор (в линейном режиме)
+void matrix_vector_product(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c)
+{
+    // Перебираем строки матрицы
+    for (int i = 0; i < c.size(); i++) {
+        c[i] = 0.0; // Инициализируем элемент результирующего вектора нулем
+        // Перебираем столбцы матрицы
+        for (int j = 0; j < b.size(); j++)
+            c[i] += a[i * b.size() + j] * b[j];
+    }   
+}
+// Функция для вычисления произведения матрицы на вектор (в параллельном режиме).
+// Строки делятся на блоки по row_block, блоки распределяются между потоками по расписанию
+// schedule_kind/schedule_chunk. Внутри блока столбцы проходятся плитками по column_tile, чтобы
+// кусок вектора b оставался в кэше для всех строк блока. Порядок сложений в строке не меняется.
+void matrix_vector_product_omp(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c)
+{
+    int rows = c.size();
+    int cols = b.size();
+    int block = row_block > 0 ? row_block : 1;
+    int tile = column_tile > 0 ? column_tile : cols;
+    int blocks = (rows + block - 1) / block;
+    omp_set_schedule((omp_sched_t)schedule_kind, schedule_chunk);
+    // Определение параллельной секции с указанием числа потоков
+    #pragma omp parallel num_threads(thread_number)
+    {
+        // Директива для распараллеливания цикла, расписание берётся из omp_set_schedule
+        #pragma omp for schedule(runtime)
+        for (int blk = 0; blk < blocks; blk++) {
+            int first = blk * block;
+            int last = std::min(first + block, rows);
+            for (int i = first; i < last; i++)
+                c[i] = 0.0;
+            for (int jt = 0; jt < cols; jt += tile) {
+                int jend = std::min(jt + tile, cols);
+                for (int i = first; i < last; i++) {
+                    double sum = c[i];
+                    for (int j = jt; j < jend; j++)
+                        sum += a[i * b.size() + j] * b[j];
+                    c[i] = sum;
+                }
+            }
+        }
+    }
+}
+
+} // namespace lab2_1
@@ -0,0 +1,69 @@
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+
+#include <math.h>
+#include <stdlib.h>
+#include "../../common/repro_sum.h"
+
+#ifdef __cplusplus
+// В C++ (общая программа замеров bench) ядра этой работы живут в своём пространстве имён
+namespace lab2_2 {
+#endif
+
+static int thread_limit = 1; // Число потоков параллельных версий
+
+// Функция, вычисляющая подынтегральную функцию
+double func(double x)
+{
+    return exp(-x * x);
+}
+
+// Функция для вычисления интеграла методом прямоугольников (линейная версия)
+double integrate(double (*func)(double), double a, double b, int n)
+{
+    double h = (b - a) / n; // Ширина каждого прямоугольника
+    size_t blocks = repro_block_count(n);
+    double* partials = (double*)malloc(sizeof(double) * blocks);
+
+    // Суммируем значения функции на серединах прямоугольников блоками фиксированного размера
+    for (size_t blk = 0; blk < blocks; blk++) {
+        repro_acc acc;
+        repro_acc_init(&acc);
+        for (size_t i = repro_block_begin(blk); i < repro_block_end(blk, n); i++)
+            repro_acc_add(&acc, func(a + h * (i + 0.5)));
+        partials[blk] = repro_acc_value(&acc);
+    }
+
+    double sum = repro_tree_sum(partials, blocks) * h;
+    free(partials);
+    return sum;
+}
+
+// Функция для вычисления интеграла методом прямоугольников (параллельная версия).
+// Блоки те же, что и в линейной версии, поэтому результат побитово совпадает с ней при любом числе потоков.
+double integrate_omp(double (*func)(double), double a, double b, int n)
+{
+    double h = (b - a) / n;
+    size_t blocks = repro_block_count(n);
+    double* partials = (double*)malloc(sizeof(double) * blocks);
+
+    // Распределение блоков по потокам; каждый блок пишет свою частичную сумму
+    #pragma omp parallel for schedule(static) num_threads(thread_limit)
+    for (size_t blk = 0; blk < blocks; blk++) {
+        repro_acc acc;
+        repro_acc_init(&acc);
+        for (size_t i = repro_block_begin(blk); i < repro_block_end(blk, n); i++)
+            repro_acc_add(&acc, func(a + h * (i + 0.5)));
+        partials[blk] = repro_acc_value(&acc);
+    }
+
+    double sum = repro_tree_sum(partials, blocks) * h;
+    free(partials);
+    return sum;
+}
+
+#ifdef __cplusplus
+} // namespace lab2_2
+#endif
+
+#endif
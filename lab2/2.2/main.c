@@ -2,13 +2,15 @@
 #include <math.h>
 #include <time.h>
 #include <omp.h>
+#include <stdlib.h>
+#include "integrate.h"
+#include "quadrature.h"
 
 const double PI = 3.14159265358979323846;
 const double a = -4.0;
 const double b = 4.0;
 const int nsteps = 40000000;
-
-int thread_limit = 0;
+const double gk_tolerance = 1e-13; // Допуск адаптивного метода
 
 // Функция для получения текущего времени процессора
 double cpuSecond()
@@ -18,61 +20,38 @@ double cpuSecond()
     return ((double)ts.tv_sec + (double)ts.tv_nsec * 1.e-9);
 }
 
-// Функция, вычисляющая подынтегральную функцию
-double func(double x)
-{
-    return exp(-x * x);
-}
+typedef double (*FunctionFunc)(double);
 
-// Функция для вычисления интеграла методом прямоугольников (линейная версия)
-double integrate(double (*func)(double), double a, double b, int n)
+double run_tests(double (*integrate_func)(FunctionFunc, double, double, int))
 {
-    double h = (b - a) / n; // Ширина каждого прямоугольника
-    double sum = 0.0;
-
-    // Суммируем значения функции на серединах прямоугольников
-    for (int i = 0; i < n; i++)
-        sum += func(a + h * (i + 0.5));
-
-    sum *= h;
-
-    return sum;
+    double t = cpuSecond();
+    double res = integrate_func(func, a, b, nsteps);
+    t = cpuSecond() - t;
+    printf("Result: %.12f; error %.12f; error on [a, b] %.3e\n", res, fabs(res - sqrt(PI)), fabs(res - sqrt(PI) * erf(b)));
+    return t;
 }
 
-// Функция для вычисления интеграла методом прямоугольников (параллельная версия)
-double integrate_omp(double (*func)(double), double a, double b, int n)
+// Метод прямоугольников с пакетной векторизованной функцией
+double run_batch_tests(void)
 {
-    double h = (b - a) / n;
-    double sum = 0.0;
-
-    #pragma omp parallel
-    {
-        double local_sum = 0.0; // Локальная сумма для каждого потока
-        
-        // Распределение итераций цикла по потокам
-        #pragma omp for
-        
-        for (int i = 0; i < n; i++)
-            local_sum += func(a + h * (i + 0.5));
-        
-        // Гарантированное выполнение операции сложения
-        #pragma omp atomic
-        sum += local_sum;
-    }
-    sum *= h;
-
-    return sum;
+    double t = cpuSecond();
+    double res = integrate_batch(gauss_batch, a, b, nsteps, thread_limit);
+    t = cpuSecond() - t;
+    printf("Result: %.12f; error %.12f; error on [a, b] %.3e\n", res, fabs(res - sqrt(PI)), fabs(res - sqrt(PI) * erf(b)));
+    return t;
 }
-typedef double (*FunctionFunc)(double);
 
-double run_tests(double (*integrate_func)(FunctionFunc, double, double, int))
+// Адаптивный метод Гаусса-Кронрода
+double run_gk_tests(void)
 {
     double t = cpuSecond();
-    double res = integrate_func(func, a, b, nsteps);
+    QuadResult res = integrate_gk(gauss_batch, a, b, gk_tolerance, thread_limit);
     t = cpuSecond() - t;
-    printf("Result: %.12f; error %.12f\n", res, fabs(res - sqrt(PI)));
+    printf("Result: %.12f; error %.12f; error on [a, b] %.3e; evaluations %lld\n",
+           res.value, fabs(res.value - sqrt(PI)), fabs(res.value - sqrt(PI) * erf(b)), res.evaluations);
     return t;
 }
+
 int main(int argc, char **argv)
 {
     int threads_n[] = { 2, 4, 7, 8, 16, 20, 40 };
@@ -82,10 +61,24 @@ int main(int argc, char **argv)
     printf("Execution time: %.6f\n", tserial);
     printf("parallel tests\n");
     for (int i = 0; i < 7; i++) {
+        thread_limit = threads_n[i];
         double tparallel = run_tests(integrate_omp);
         printf("Execution time (parallel %d threads): %.6f\n", threads_n[i], tparallel);
         printf("Speedup: %.2f\n", tserial / tparallel);
+    }
+    printf("vectorized batch tests\n");
+    for (int i = 0; i < 7; i++) {
         thread_limit = threads_n[i];
+        double tparallel = run_batch_tests();
+        printf("Execution time (batch %d threads): %.6f\n", threads_n[i], tparallel);
+        printf("Speedup: %.2f\n", tserial / tparallel);
+    }
+    printf("adaptive Gauss-Kronrod tests (tolerance %.1e)\n", gk_tolerance);
+    for (int i = 0; i < 7; i++) {
+        thread_limit = threads_n[i];
+        double tparallel = run_gk_tests();
+        printf("Execution time (Gauss-Kronrod %d threads): %.6f\n", threads_n[i], tparallel);
+        printf("Speedup: %.2f\n", tserial / tparallel);
     }
     return 0;
 }
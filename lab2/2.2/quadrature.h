@@ -0,0 +1,171 @@
+#ifndef QUADRATURE_H
+#define QUADRATURE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <omp.h>
+#include "../../common/repro_sum.h"
+
+#ifdef __cplusplus
+namespace lab2_2 {
+#endif
+
+// Подынтегральная функция, вычисляющая значения сразу для массива точек: y[i] = f(x[i]).
+// В отличие от вызова через указатель на каждую точку, тело такой функции компилятор векторизует.
+typedef void (*BatchFunc)(const double* x, double* y, int n);
+
+// Векторизуемая экспонента: x = k*ln2 + r, |r| <= ln2/2, exp(r) - многочлен Тейлора 13-й степени,
+// 2^k собирается прямо в битах порядка. Округление k - через "магическую" константу 1.5*2^52,
+// без вызовов библиотеки и без -ffast-math (которого не выдерживает компенсированное суммирование).
+// Относительная ошибка около 2e-16; аргумент должен лежать в [-708, 709]: проверка границ
+// внутри цикла мешает векторизации (сравнение double без -fno-trapping-math не if-конвертируется).
+#pragma omp declare simd
+static inline double vexp(double x)
+{
+    const double log2e = 1.4426950408889634;
+    const double ln2_hi = 6.93147180369123816490e-01;
+    const double ln2_lo = 1.90821492927058770002e-10;
+    const double shifter = 6755399441055744.0; // 1.5 * 2^52
+    double kd = x * log2e + shifter;
+    double k = kd - shifter;
+    double r = x - k * ln2_hi - k * ln2_lo;
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    // Младшие биты kd содержат k, сдвиг в поле порядка даёт 2^k
+    uint64_t kbits, scale_bits;
+    memcpy(&kbits, &kd, sizeof(kbits));
+    scale_bits = (kbits - 0x4338000000000000ULL + 1023) << 52;
+    double scale;
+    memcpy(&scale, &scale_bits, sizeof(scale));
+    return p * scale;
+}
+
+// exp(-x^2) для массива точек, |x| <= 26
+static inline void gauss_batch(const double* x, double* y, int n)
+{
+    #pragma omp simd
+    for (int i = 0; i < n; i++)
+        y[i] = vexp(-x[i] * x[i]);
+}
+
+// Метод средних прямоугольников с пакетным вычислением функции.
+// Точки делятся на блоки REPRO_BLOCK, блок вычисляется одним вызовом f и суммируется
+// воспроизводимо, поэтому результат не зависит от threads.
+static inline double integrate_batch(BatchFunc f, double a, double b, int n, int threads)
+{
+    double h = (b - a) / n;
+    size_t blocks = repro_block_count(n);
+    double* partials = (double*)malloc(sizeof(double) * blocks);
+
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (size_t blk = 0; blk < blocks; blk++) {
+        double x[REPRO_BLOCK], y[REPRO_BLOCK];
+        size_t begin = repro_block_begin(blk);
+        int count = (int)(repro_block_end(blk, n) - begin);
+        for (int i = 0; i < count; i++)
+            x[i] = a + h * ((double)(begin + i) + 0.5);
+        f(x, y, count);
+        partials[blk] = repro_sum_lanes(y, count);
+    }
+
+    double sum = repro_tree_sum(partials, blocks) * h;
+    free(partials);
+    return sum;
+}
+
+// Узлы и веса правила Гаусса-Кронрода 7-15 (QUADPACK qk15) на [-1, 1]
+static const double gk15_nodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+static const double gk15_kronrod_weights[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+// Веса Гаусса для узлов gk15_nodes[1], [3], [5], [7]
+static const double gk15_gauss_weights[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+typedef struct {
+    double value; // Значение интеграла
+    long long evaluations; // Количество вычислений функции
+} QuadResult;
+
+// Глубина, до которой половины отрезка отдаются отдельным задачам
+#define GK_TASK_DEPTH 12
+// Ограничение глубины деления на случай особенностей
+#define GK_MAX_DEPTH 50
+
+// Адаптивное интегрирование на [a, b]: если оценка ошибки |K15 - G7| больше допуска, отрезок
+// делится пополам, и половины считаются задачами OpenMP. Результаты половин складываются в
+// порядке дерева деления, так что значение не зависит от числа потоков.
+static QuadResult integrate_gk_segment(BatchFunc f, double a, double b, double tol, int depth)
+{
+    double center = 0.5 * (a + b);
+    double half_length = 0.5 * (b - a);
+    double x[15], y[15];
+    for (int j = 0; j < 7; j++) {
+        x[2 * j] = center - half_length * gk15_nodes[j];
+        x[2 * j + 1] = center + half_length * gk15_nodes[j];
+    }
+    x[14] = center;
+    f(x, y, 15);
+
+    double kronrod = gk15_kronrod_weights[7] * y[14];
+    double gauss = gk15_gauss_weights[3] * y[14];
+    for (int j = 0; j < 7; j++) {
+        double pair = y[2 * j] + y[2 * j + 1];
+        kronrod += gk15_kronrod_weights[j] * pair;
+        if (j % 2 == 1)
+            gauss += gk15_gauss_weights[j / 2] * pair;
+    }
+    kronrod *= half_length;
+    gauss *= half_length;
+
+    QuadResult result = { kronrod, 15 };
+    if (fabs(kronrod - gauss) <= tol || depth >= GK_MAX_DEPTH)
+        return result;
+
+    QuadResult left, right;
+    #pragma omp task shared(left) if(depth < GK_TASK_DEPTH)
+    left = integrate_gk_segment(f, a, center, 0.5 * tol, depth + 1);
+    right = integrate_gk_segment(f, center, b, 0.5 * tol, depth + 1);
+    #pragma omp taskwait
+    result.value = left.value + right.value;
+    result.evaluations += left.evaluations + right.evaluations;
+    return result;
+}
+
+static inline QuadResult integrate_gk(BatchFunc f, double a, double b, double tol, int threads)
+{
+    QuadResult result;
+    #pragma omp parallel num_threads(threads)
+    #pragma omp single
+    result = integrate_gk_segment(f, a, b, tol, 0);
+    return result;
+}
+
+#ifdef __cplusplus
+} // namespace lab2_2
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef SIMPLE_ITERATION_H
+#define SIMPLE_ITERATION_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "../../common/repro_sum.h"
+
+#ifdef __cplusplus
+// Для C++ (bench) - своё пространство имён, в C его нет
+namespace lab2_3 {
+#endif
+
+static double epsilon = 0.00001; // Точность сходимости
+static double iteration_step = 0.00001; // Шаг итерации
+
+static int threads_number = 0;
+static int iteration_schedule = omp_sched_guided; // Расписание цикла умножения во второй реализации (omp_sched_t)
+static int iteration_chunk = 40;
+
+// Параллельное вычисление скалярного произведения векторов
+void parallel_dot(double* A, double* b, double* c, int n, int m) {
+    #pragma omp parallel num_threads(threads_number)
+    {
+    #pragma omp for
+    for (int i = 0; i < n; i++) {
+        c[i] = 0;
+        for (int j = 0; j < m; j++)
+            c[i] += A[i * n + j] * b[j]; // Умножаем соответствующие элементы строки на соответствующие элементы вектора и складываем их
+        }
+    } 
+}
+
+// Линейное вычисление скалярного произведения векторов
+void serial_dot(double* A, double* b, double* c, int n, int m) {
+    for (int i = 0; i < n; i++) {
+        c[i] = 0;
+        for (int j = 0; j < m; j++)
+            c[i] += A[i * n + j] * b[j];
+    }
+}
+
+// Вычисление длины вектора
+double vector_length(double* vec, int n) {
+    double vec_length_sum = 0;
+    for (int i = 0; i < n; i++)
+        vec_length_sum += vec[i] * vec[i]; // Добавляем квадрат текущего элемента к сумме
+    return sqrt(vec_length_sum); // Возвращаем квадратный корень из суммы квадратов (длину)
+}
+
+void simple_iteration_method_first_realization_serial(double* A, double* x, double* b, int n) {
+    double* xn = (double*)malloc(sizeof(double) * n); // Временный вектор для хранения результатов умножения A и x
+    double* x_offset = (double*)malloc(sizeof(double) * n); // Вектор для хранения разности между xn и b
+    double* partials = (double*)malloc(sizeof(double) * repro_block_count(n)); // Частичные суммы блоков для длины x_offset
+    double convergence_coeff = 1; // Коэффициент сходимости
+    double b_length = vector_length(b, n);
+    while (convergence_coeff > epsilon) {
+        serial_dot(A, x, xn, n, n); // Умножение матрицы A на вектор x
+        for (int i = 0; i < n; i++) {
+            x_offset[i] = (xn[i] - b[i]); // Вычисляем разность между соответствующими элементами
+            x[i] = x[i] - iteration_step * x_offset[i]; // Обновляем элемент вектора x
+        }
+        double x_offset_length = repro_sum_squares_omp(x_offset, n, partials); // Квадрат длины x_offset (воспроизводимая сумма)
+        convergence_coeff = sqrt(x_offset_length) / b_length; // Вычисляем коэффициент сходимости
+    }
+    free(xn);
+    free(x_offset);
+    free(partials);
+}
+
+void simple_iteration_method_first_realization_parallel(double* A, double* x, double* b, int n) {
+    double* xn = (double*)malloc(sizeof(double) * n);
+    double* x_offset = (double*)malloc(sizeof(double) * n);
+    double* partials = (double*)malloc(sizeof(double) * repro_block_count(n));
+    double convergence_coeff = 1;
+    int iteration_count = 0;
+    double b_length = vector_length(b, n);
+    while (convergence_coeff > epsilon) {
+        parallel_dot(A, x, xn, n, n);
+        for (int i = 0; i < n; i++) {
+            x_offset[i] = (xn[i] - b[i]);
+            x[i] = x[i] - iteration_step * x_offset[i];
+        }
+        double x_offset_length = repro_sum_squares_omp(x_offset, n, partials);
+        convergence_coeff = sqrt(x_offset_length) / b_length;
+    }
+    free(xn);
+    free(x_offset);
+    free(partials);
+}
+
+void simple_iteration_method_second_realization(double* A, double* x, double* b, int n) {
+    double* xn = (double*)malloc(sizeof(double) * n); // Ax
+    double* x_offset = (double*)malloc(sizeof(double) * n); // Ax - b
+    double* minimize_vector = (double*)malloc(sizeof(double) * n); // (Ax - b) * tau
+    double* partials = (double*)malloc(sizeof(double) * repro_block_count(n)); // Частичные суммы блоков для длины x_offset
+    double convergence_coeff = 1;
+    double b_length = vector_length(b, n);
+    char stop = 0; // Флаг остановки выполнения итерационного процесса
+    omp_set_schedule((omp_sched_t)iteration_schedule, iteration_chunk);
+    #pragma omp parallel num_threads(threads_number) shared(stop)
+    {
+    while ((convergence_coeff > epsilon) && !stop) {
+        // Параллельно вычисляем результат умножения матрицы A на вектор x и разность между этим результатом и вектором b
+        #pragma omp for schedule(runtime)
+        for (int i = 0; i < n; i++) {
+            xn[i] = 0;
+            for (int j = 0; j < n; j++)
+                xn[i] += A[i * n + j] * x[j]; // Вычисляем i-ый элемент результирующего вектора
+            x_offset[i] = (xn[i] - b[i]); // Вычисляем разность между соответствующими элементами
+            minimize_vector[i] = iteration_step * x_offset[i]; // Вычисляем произведение разности на тау
+        }
+        // Квадрат длины x_offset: блоки делятся между потоками, результат не зависит от их числа
+        double x_offset_length = repro_sum_squares_omp(x_offset, n, partials);
+
+        #pragma omp for 
+        for (int i = 0; i < n ; i++)
+            x[i] = x[i] - minimize_vector[i]; // Обновляем вектор x в соответствии с произведением разности итераций на тау
+        #pragma omp single
+        convergence_coeff = sqrt(x_offset_length) / b_length; // Вычисляем коэффициент сходимости
+    }
+    stop = 1;
+    }
+    free(xn);
+    free(x_offset);
+    free(minimize_vector);
+    free(partials);
+}
+
+#ifdef __cplusplus
+} // namespace lab2_3
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace lab3_1 {
+
+static int row_block = 0; // Строк в блоке, который поток берёт из общей очереди; 0 - строки делятся поровну заранее
+
+// Функция для вычисления произведения матрицы и вектора в заданных пределах
+void matrix_vector_product(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, int lb, int rb)
+{
+    for (int i = lb; i < rb; i++) {
+        c[i] = 0.0;
+        for (int j = 0; j < b.size(); j++)
+            c[i] += a[i * b.size() + j] * b[j]; // Результат скалярного произведения i-й строки матрицы a и вектора b
+    }
+}
+
+// Функция для инициализации матрицы и вектора в заданных пределах
+void matrix_vector_init(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, int lb, int rb) {
+    for (int i = lb; i < rb; i++) {
+        for (int j = 0; j < b.size(); j++) {
+            a[i * b.size() + j] = i + j;
+        }
+    }
+    // Инициализация вектора b. b.size() == c.size(), поэтому можно использовать те же границы для c.
+    for (int j = lb; j < rb; j++)
+        b[j] = j;
+}
+
+
+void parallelize_task(void (*func)(std::vector<double>&, std::vector<double>&, std::vector<double>&, int, int), std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, int n, int m, int num_of_threads) {
+    std::vector<std::thread> thread_pool;
+    if (row_block > 0) {
+        // Динамическое распределение: потоки по очереди забирают следующие row_block строк
+        std::atomic<int> next_row{0};
+        for (int i = 0; i < num_of_threads; i++) {
+            thread_pool.emplace_back([&] {
+                for (int lb = next_row.fetch_add(row_block); lb < n; lb = next_row.fetch_add(row_block))
+                    func(a, b, c, lb, std::min(lb + row_block, n));
+            });
+        }
+        for (auto& thread : thread_pool)
+            thread.join();
+        return;
+    }
+    int last_lb = 0;
+    for (int i = 0; i < num_of_threads; i++) {
+        int tasks_count = n / num_of_threads + ((n % num_of_threads) - i > 0); // Определение количества задач для текущего потока
+        std::thread thread(func, std::ref(a), std::ref(b), std::ref(c), std::move(last_lb), std::move(last_lb + tasks_count)); // Создание нового потока, который будет выполнять функцию func с заданными параметрами
+        thread_pool.push_back(std::move(thread)); // Добавление потока в пул
+        last_lb += tasks_count; // Обновление левой границы для следующего потока
+    }
+    // Ожидание завершения всех потоков
+    for (auto& thread : thread_pool) {
+        thread.join(); // Блокирует выполнение текущего потока до завершения работы потока thread
+    }
+}
+
+} // namespace lab3_1
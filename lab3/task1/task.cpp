@@ -1,47 +1,26 @@
 #include <thread>
 #include <iostream>
 #include <vector>
+#include "matrix_vector.h"
+#include "../../common/autotune.h"
 
-// Функция для вычисления произведения матрицы и вектора в заданных пределах
-void matrix_vector_product(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, int lb, int rb)
-{
-    for (int i = lb; i < rb; i++) {
-        c[i] = 0.0;
-        for (int j = 0; j < b.size(); j++)
-            c[i] += a[i * b.size() + j] * b[j]; // Результат скалярного произведения i-й строки матрицы a и вектора b
-    }
-}
+using namespace lab3_1;
 
-// Функция для инициализации матрицы и вектора в заданных пределах
-void matrix_vector_init(std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, int lb, int rb) {
-    for (int i = lb; i < rb; i++) {
-        for (int j = 0; j < b.size(); j++) {
-            a[i * b.size() + j] = i + j;
-        }
-    }
-    // Инициализация вектора b. b.size() == c.size(), поэтому можно использовать те же границы для c.
-    for (int j = lb; j < rb; j++)
-        b[j] = j;
+void doSomething(int id) {
+    std::cout << id << "\n";
 }
 
+struct tune_data {
+    std::vector<double> a, b, c;
+    int n, m;
+};
 
-void parallelize_task(void (*func)(std::vector<double>&, std::vector<double>&, std::vector<double>&, int, int), std::vector<double>& a, std::vector<double>& b, std::vector<double>& c, int n, int m, int num_of_threads) {
-    std::vector<std::thread> thread_pool;
-    int last_lb = 0;
-    for (int i = 0; i < num_of_threads; i++) {
-        int tasks_count = n / num_of_threads + ((n % num_of_threads) - i > 0); // Определение количества задач для текущего потока
-        std::thread thread(func, std::ref(a), std::ref(b), std::ref(c), std::move(last_lb), std::move(last_lb + tasks_count)); // Создание нового потока, который будет выполнять функцию func с заданными параметрами
-        thread_pool.push_back(std::move(thread)); // Добавление потока в пул
-        last_lb += tasks_count; // Обновление левой границы для следующего потока
-    }
-    // Ожидание завершения всех потоков
-    for (auto& thread : thread_pool) {
-        thread.join(); // Блокирует выполнение текущего потока до завершения работы потока thread
-    }
-}
-
-void doSomething(int id) {
-    std::cout << id << "\n";
+// Инициализация и произведение с числом потоков и размером блока строк из автонастройки
+void run_tuned(const tune_config* cfg, void* ctx) {
+    tune_data* data = static_cast<tune_data*>(ctx);
+    row_block = cfg->row_block;
+    parallelize_task(matrix_vector_init, data->a, data->b, data->c, data->n, data->m, cfg->threads);
+    parallelize_task(matrix_vector_product, data->a, data->b, data->c, data->n, data->m, cfg->threads);
 }
 
 int main() {
@@ -80,6 +59,24 @@ int main() {
             std::cout << "Elapsed time: " << parallel_time << "\n";
             std::cout << "Speed-up: " << serial_time / parallel_time << "\n";
         }
+
+        // Потоки и блок строк подбираются при первом запуске и берутся из autotune.cache в следующих
+        std::cout << "Tuned test\n";
+        tune_data data{std::vector<double>(n * m), std::vector<double>(n), std::vector<double>(n), n, m};
+        tune_space space = tune_default_space();
+        int row_blocks[] = { 0, 16, 64, 256, 1024 };
+        std::copy(row_blocks, row_blocks + 5, space.row_block.values);
+        space.row_block.count = 5;
+        tune_config initial = { tune_num_procs(), 0, 0, 0, 0 };
+        tune_config cfg = autotune("lab3.task1/gemv_threads", (long long)n * m, space, initial, run_tuned, &data);
+        tune_print("lab3.task1/gemv_threads", &cfg);
+        const auto tuned_start{std::chrono::steady_clock::now()};
+        run_tuned(&cfg, &data);
+        const auto tuned_end{std::chrono::steady_clock::now()};
+        const std::chrono::duration<double> tuned_seconds{tuned_end - tuned_start};
+        std::cout << "Elapsed time: " << tuned_seconds.count() << "\n";
+        std::cout << "Speed-up: " << serial_time / tuned_seconds.count() << "\n";
+        row_block = 0;
     }
     return 0;
 }
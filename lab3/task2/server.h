@@ -0,0 +1,436 @@
+#pragma once
+
+#include <cmath>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Сервер задач: очередь, пул рабочих потоков, зависимости между задачами и ожидание результата
+// через request_result или co_await submit
+namespace lab3_2 {
+
+template <typename T>
+class safe_que {
+    std::queue<T> que; // Очередь для хранения элементов
+    std::mutex que_lock; // Мьютекс для синхронизации доступа к очереди
+public:
+    // Класс, представляющий узел очереди, который безопасен для доступа из разных потоков
+    class safe_que_return_node {
+        T* value = 0;
+    public:
+        void set_value(T val) {
+            this->value = new T(val);
+        }
+        T* get_value() {
+            return this->value;
+        }
+        ~safe_que_return_node() {
+            delete value;
+        }
+    };
+    // Метод для добавления элемента в очередь
+    void push(T val) {
+        que_lock.lock();
+        que.push(val);
+        que_lock.unlock();
+    }
+    // Метод для проверки, пустая ли очередь
+    bool empty() {
+        return que.empty();
+    }
+    // Метод для извлечения элемента из очереди
+    T pop() {
+        que_lock.lock();
+        T val = que.front();
+        que.pop();
+        que_lock.unlock();
+        return val;
+    }
+};
+
+template <typename T>
+class Task {
+public:
+    Task() { };
+    virtual void say_name() = 0;
+    virtual T do_task() = 0;
+    // Выполнение задачи с результатами предшественников (в порядке, в котором они указаны при добавлении).
+    // По умолчанию результаты не используются
+    virtual T do_task(const std::vector<T>&) {
+        return do_task();
+    }
+};
+
+template <typename T>
+class SinTask : public Task<T> {
+    T arg1;
+public:
+    std::string task_name = "SinTask";
+    SinTask(T arg1) {
+        this->arg1 = arg1;
+    }
+    void say_name() {
+        std::cout << task_name;
+    }
+    T do_task() {
+        return std::sin(this->arg1);
+    }
+    // Аргумент - результат первого предшественника
+    T do_task(const std::vector<T>& inputs) {
+        return inputs.empty() ? do_task() : std::sin(inputs[0]);
+    }
+};
+template <typename T>
+class SqrtTask : public Task<T> {
+    T arg1;
+public:
+    std::string task_name = "SqrtTask";
+    SqrtTask(T arg1) {
+        this->arg1 = arg1;
+    }
+    void say_name() {
+        std::cout << task_name;
+    }
+    T do_task() {
+        return std::sqrt(this->arg1);
+    }
+    T do_task(const std::vector<T>& inputs) {
+        return inputs.empty() ? do_task() : std::sqrt(inputs[0]);
+    }
+};
+template <typename T>
+class PowTask : public Task<T> {
+    T arg1, arg2;
+    // Общая часть обеих версий do_task: имитация работы и возведение в степень
+    T compute(T base, T exponent) {
+        int asd= 0;
+        for (int i = 0; i < 100000; i++) {
+            asd = i;
+        }
+        return std::pow(base, exponent);
+    }
+public:
+    std::string task_name = "PowTask";
+    PowTask(T arg1, T arg2) {
+        this->arg1 = arg1;
+        this->arg2 = arg2;
+    }
+    void say_name() {
+        std::cout << task_name;
+    }
+    T do_task() {
+        return compute(this->arg1, this->arg2);
+    }
+    // Результаты предшественников заменяют аргументы по порядку: основание, затем показатель
+    T do_task(const std::vector<T>& inputs) {
+        if (inputs.empty())
+            return do_task();
+        return compute(inputs[0], inputs.size() > 1 ? inputs[1] : this->arg2);
+    }
+};
+
+// Небольшой пул потоков, на котором продолжаются сопрограммы клиентов после завершения их задач.
+// Тысячи логических клиентов делят несколько потоков, а не занимают по потоку на каждого
+class executor {
+    std::queue<std::coroutine_handle<>> ready; // Сопрограммы, готовые к продолжению
+    std::mutex ready_lock;
+    std::condition_variable ready_check;
+    std::vector<std::thread> thread_pool;
+    bool running = false;
+
+    void run() {
+        while (true) {
+            std::unique_lock<std::mutex> locker(ready_lock);
+            while (ready.empty() && running)
+                ready_check.wait(locker);
+            if (ready.empty())
+                return;
+            std::coroutine_handle<> handle = ready.front();
+            ready.pop();
+            locker.unlock();
+            handle.resume();
+        }
+    }
+public:
+    ~executor() {
+        if (running)
+            this->stop();
+    }
+    void start(size_t num_of_threads = 1) {
+        running = true;
+        for (size_t i = 0; i < num_of_threads; i++)
+            thread_pool.push_back(std::thread(&executor::run, this));
+    }
+    // Остановка после того, как очередь готовых сопрограмм опустеет
+    void stop() {
+        ready_lock.lock();
+        running = false;
+        ready_check.notify_all();
+        ready_lock.unlock();
+        for (std::thread& thread : thread_pool)
+            thread.join();
+        thread_pool.clear();
+    }
+    void post(std::coroutine_handle<> handle) {
+        ready_lock.lock();
+        ready.push(handle);
+        ready_check.notify_one();
+        ready_lock.unlock();
+    }
+};
+
+// Сопрограмма клиента, запускаемая без ожидания: выполняется сразу до первого co_await,
+// а по завершении сама освобождает свой кадр
+struct client_coroutine {
+    struct promise_type {
+        client_coroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <typename T>
+class Server {
+private:
+    struct task_with_id {
+        Task<T>* task;
+        size_t id;
+        std::vector<T> inputs; // Результаты предшественников
+    };
+    // Задача, ожидающая завершения предшественников
+    struct pending_task {
+        task_with_id task;
+        size_t waiting; // Сколько предшественников ещё не завершено
+    };
+    // Место для результата предшественника: задача-последователь и номер её аргумента
+    struct successor_slot {
+        size_t id;
+        size_t input;
+    };
+    std::condition_variable server_check; // Условная переменная для проверки состояния сервера
+    std::condition_variable client_check; // Условная переменная для проверки состояния клиента
+    size_t num_of_workers = 1; // Количество рабочих потоков
+    safe_que<task_with_id> task_que; // Безопасная очередь задач
+    safe_que<size_t> free_ids; // Очередь свободных идентификаторов задач
+    size_t max_id = 0; // Максимальный идентификатор задачи
+    std::unordered_map<size_t, T> task_result; // Карта результатов задач
+    std::unordered_map<size_t, pending_task> pending_tasks; // Задачи, ожидающие предшественников
+    std::unordered_map<size_t, std::vector<successor_slot>> successors; // Кому передать результат задачи
+    std::unordered_set<size_t> released_ids; // Задачи, результат которых клиенту не нужен
+    // Сопрограмма, ожидающая результат задачи, и место для него
+    struct waiting_coroutine {
+        std::coroutine_handle<> handle;
+        T* result;
+        executor* where; // nullptr - продолжить в рабочем потоке сервера
+    };
+    std::unordered_map<size_t, waiting_coroutine> awaiting; // Ожидающие сопрограммы по идентификатору задачи
+    std::vector<std::thread> event_thread_pool; // Пул потоков для обработки задач
+    bool running = false; // Флаг, указывающий, работает ли сервер
+    bool stopped = true; // Флаг, указывающий, остановлен ли сервер
+    std::mutex server_lock; // Мьютекс для синхронизации доступа к серверу
+    std::mutex cv_client_lock; // Мьютекс для синхронизации доступа к клиентам
+
+    // Метод для обработки задач в потоках
+    void event_loop() {
+        while (running) {
+            std::unique_lock<std::mutex> locker(server_lock);
+            while (task_que.empty()) {
+                server_check.wait(locker);
+                if (!running)
+                    return;
+            }
+            locker.unlock();
+            task_with_id task_struct;
+            task_struct.id = -1;
+            server_lock.lock();
+            if (!task_que.empty())
+                task_struct = task_que.pop();
+            server_lock.unlock();
+            if (task_struct.id != -1) {
+                T return_value = task_struct.task->do_task(task_struct.inputs);
+                waiting_coroutine resume = { nullptr, nullptr, nullptr };
+                cv_client_lock.lock();
+                pass_to_successors(task_struct.id, return_value);
+                auto waiting = awaiting.find(task_struct.id);
+                if (waiting != awaiting.end()) {
+                    resume = waiting->second;
+                    *resume.result = return_value;
+                    awaiting.erase(waiting);
+                }
+                if (released_ids.erase(task_struct.id) || resume.handle) {
+                    server_lock.lock();
+                    free_ids.push(task_struct.id);
+                    server_lock.unlock();
+                }
+                else {
+                    task_result.insert(std::make_pair(task_struct.id, return_value));
+                    client_check.notify_all();
+                }
+                cv_client_lock.unlock();
+                // Сопрограмма продолжается вне блокировок: она может сразу отправить следующую задачу
+                if (resume.where)
+                    resume.where->post(resume.handle);
+                else if (resume.handle)
+                    resume.handle.resume();
+            }
+        }
+    }
+    // Передача результата задачи id ожидающим её последователям; готовые последователи ставятся в очередь.
+    // Вызывается под cv_client_lock
+    void pass_to_successors(size_t id, T value) {
+        auto waiting = successors.find(id);
+        if (waiting == successors.end())
+            return;
+        for (successor_slot slot : waiting->second) {
+            pending_task& successor = pending_tasks.at(slot.id);
+            successor.task.inputs[slot.input] = value;
+            if (--successor.waiting == 0) {
+                enqueue(std::move(successor.task));
+                pending_tasks.erase(slot.id);
+            }
+        }
+        successors.erase(waiting);
+    }
+    void enqueue(task_with_id task) {
+        server_lock.lock();
+        task_que.push(std::move(task));
+        server_check.notify_one();
+        server_lock.unlock();
+    }
+    // Метод для получения свободного идентификатора задачи
+    size_t get_free_id() {
+        server_lock.lock();
+        if (free_ids.empty()) {
+            free_ids.push(max_id++);
+        }
+        size_t free_id = free_ids.pop();
+        server_lock.unlock();
+        return free_id;
+    }
+public:
+    ~Server() {
+        if (!stopped) {
+            this->stop();
+        }
+    }
+    // Метод для запуска сервера
+    void start(size_t num_of_workers = 1) {
+        running = true;
+        stopped = false;
+        for (int i = 0; i < num_of_workers; i++) {
+            event_thread_pool.push_back(std::thread(&Server::event_loop, this));
+        }
+    }
+    // Метод для остановки сервера
+    void stop() {
+        // Флаг меняется под server_lock, чтобы рабочий поток не пропустил пробуждение между проверкой очереди и wait
+        server_lock.lock();
+        running = false;
+        server_check.notify_all();
+        server_lock.unlock();
+        stopped = true;
+        for (std::thread& event_thread : this->event_thread_pool) {
+            event_thread.join();
+        }
+    }
+    // Метод для добавления задачи на сервер
+    size_t add_task(Task<T>* task) {
+        size_t free_id = get_free_id();
+        enqueue({ task, free_id });
+        return free_id;
+    }
+    // Метод для добавления задачи, зависящей от других: задача запускается, как только завершены все
+    // предшественники dependencies, и получает их результаты в do_task(inputs) в том же порядке.
+    // Результаты предшественников нельзя забирать через request_result или release_result до добавления последователя
+    size_t add_task(Task<T>* task, const std::vector<size_t>& dependencies) {
+        size_t free_id = get_free_id();
+        task_with_id task_to_add = { task, free_id, std::vector<T>(dependencies.size()) };
+        size_t waiting = 0;
+        std::unique_lock<std::mutex> locker(cv_client_lock);
+        for (size_t i = 0; i < dependencies.size(); i++) {
+            auto done = task_result.find(dependencies[i]);
+            if (done != task_result.end())
+                task_to_add.inputs[i] = done->second;
+            else {
+                successors[dependencies[i]].push_back({ free_id, i });
+                waiting++;
+            }
+        }
+        if (waiting == 0)
+            enqueue(std::move(task_to_add));
+        else
+            pending_tasks.insert(std::make_pair(free_id, pending_task{ std::move(task_to_add), waiting }));
+        return free_id;
+    }
+    // Ожидание результата задачи в сопрограмме: co_await server.submit(task) приостанавливает
+    // сопрограмму, а рабочий поток, завершивший задачу, продолжает её (через executor, если он указан)
+    class result_awaiter {
+        Server* server;
+        size_t id;
+        executor* where;
+        T result{};
+    public:
+        result_awaiter(Server* server, size_t id, executor* where) : server(server), id(id), where(where) { }
+        bool await_ready() { return false; }
+        // false - задача уже выполнена, приостанавливаться не нужно
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return server->await_result(id, handle, &result, where);
+        }
+        T await_resume() { return result; }
+    };
+    result_awaiter submit(Task<T>* task, executor* where = nullptr) {
+        return result_awaiter(this, add_task(task), where);
+    }
+    // Регистрация сопрограммы, ожидающей задачу id; если результат уже готов, он забирается сразу
+    bool await_result(size_t id, std::coroutine_handle<> handle, T* result, executor* where) {
+        std::unique_lock<std::mutex> locker(cv_client_lock);
+        auto done = task_result.find(id);
+        if (done != task_result.end()) {
+            *result = done->second;
+            task_result.erase(done);
+            server_lock.lock();
+            free_ids.push(id);
+            server_lock.unlock();
+            return false;
+        }
+        awaiting.insert(std::make_pair(id, waiting_coroutine{ handle, result, where }));
+        return true;
+    }
+    // Метод для отказа от результата задачи (например, промежуточного этапа цепочки): результат
+    // удаляется, а идентификатор освобождается сразу после завершения задачи и передачи результата последователям
+    void release_result(size_t id) {
+        std::unique_lock<std::mutex> locker(cv_client_lock);
+        if (task_result.erase(id)) {
+            server_lock.lock();
+            free_ids.push(id);
+            server_lock.unlock();
+        }
+        else
+            released_ids.insert(id);
+    }
+    // Метод для запроса результата выполнения задачи по идентификатору
+    T request_result(size_t id) {
+        std::unique_lock<std::mutex> locker(cv_client_lock);
+        while (task_result.find(id) == task_result.end()) {
+            client_check.wait(locker);
+        }
+        T result = task_result.at(id);
+        server_lock.lock();
+        task_result.erase(id);
+        free_ids.push(id);
+        server_lock.unlock();
+        return result;
+    }
+};
+
+} // namespace lab3_2
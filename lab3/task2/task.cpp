@@ -1,231 +1,123 @@
-#include <queue>
-#include <unordered_map>
-#include <cmath>
-#include <thread>
-#include <condition_variable>
 #include <chrono>
-#include <mutex>
 #include <future>
 #include <iostream>
+#include <latch>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "server.h"
+
+using namespace lab3_2;
 
 // Глобальная переменная для блокировки потоков при выводе
 std::mutex thread_lock;
 
-
+// Функция для передачи задач серверу и ожидания их выполнения
 template <typename T>
-class safe_que {
-    std::queue<T> que; // Очередь для хранения элементов
-    std::mutex que_lock; // Мьютекс для синхронизации доступа к очереди
-public:
-    // Класс, представляющий узел очереди, который безопасен для доступа из разных потоков
-    class safe_que_return_node {
-        T* value = 0;
-    public:
-        void set_value(T val) {
-            this->value = new T(val);
-        }
-        T* get_value() {
-            return this->value;
-        }
-        ~safe_que_return_node() {
-            delete value;
-        }
-    };
-    // Метод для добавления элемента в очередь
-    void push(T val) {
-        que_lock.lock();
-        que.push(val);
-        que_lock.unlock();
-    }
-    // Метод для проверки, пустая ли очередь
-    bool empty() {
-        return que.empty();
+void give_task_to_server(Server<T>* server, Task<T>* task, int num_of_tasks) {
+    std::vector<size_t> task_ids(num_of_tasks);
+    for (int i = 0; i < num_of_tasks; i++) {
+        task_ids[i] = server->add_task(task);
     }
-    // Метод для извлечения элемента из очереди
-    T pop() {
-        que_lock.lock();
-        T val = que.front();
-        que.pop();
-        que_lock.unlock();
-        return val;
+    for (auto task_id : task_ids) {
+        T result = server->request_result(task_id);
     }
-};
-
-template <typename T>
-class Task {
-public:
-    Task() { };
-    virtual void say_name() = 0;
-    virtual T do_task() = 0;
-};
+}
 
+// Цепочка sqrt(x) -> sin -> pow(., 2): клиент ждёт каждый этап, прежде чем отправить следующий
 template <typename T>
-class SinTask : public Task<T> {
-    T arg1;
-public:
-    std::string task_name = "SinTask";
-    SinTask(T arg1) {
-        this->arg1 = arg1;
-    }
-    void say_name() {
-        std::cout << task_name;
+void give_pipeline_blocking(Server<T>* server, int num_of_pipelines) {
+    SqrtTask<T> sqrt_task(25);
+    for (int i = 0; i < num_of_pipelines; i++) {
+        T root = server->request_result(server->add_task(&sqrt_task));
+        SinTask<T> sin_task(root);
+        T sine = server->request_result(server->add_task(&sin_task));
+        PowTask<T> pow_task(sine, 2);
+        server->request_result(server->add_task(&pow_task));
     }
-    T do_task() {
-        return std::sin(this->arg1);
-    }
-};
-template <typename T>
-class SqrtTask : public Task<T> {
-    T arg1;
-public:
-    std::string task_name = "SqrtTask";
-    SqrtTask(T arg1) {
-        this->arg1 = arg1;
-    }
-    void say_name() {
-        std::cout << task_name;
-    }
-    T do_task() {
-        return std::sqrt(this->arg1);
-    }
-};
+}
+
+// Та же цепочка через зависимости: все этапы отправляются сразу, клиент ждёт только конечный результат
 template <typename T>
-class PowTask : public Task<T> {
-    T arg1, arg2;
-public:
-    std::string task_name = "PowTask";
-    PowTask(T arg1, T arg2) {
-        this->arg1 = arg1;
-        this->arg2 = arg2;
-    }
-    void say_name() {
-        std::cout << task_name;
+void give_pipeline_to_server(Server<T>* server, int num_of_pipelines) {
+    SqrtTask<T> sqrt_task(25);
+    SinTask<T> sin_task(0);
+    PowTask<T> pow_task(0, 2);
+    std::vector<size_t> result_ids(num_of_pipelines);
+    for (int i = 0; i < num_of_pipelines; i++) {
+        size_t root = server->add_task(&sqrt_task);
+        size_t sine = server->add_task(&sin_task, { root });
+        result_ids[i] = server->add_task(&pow_task, { sine });
+        server->release_result(root);
+        server->release_result(sine);
+    }
+    for (auto result_id : result_ids) {
+        server->request_result(result_id);
     }
-    T do_task() {
-        int asd= 0;
-        for (int i = 0; i < 100000; i++) {
-            asd = i;
-        }
-        return std::pow(this->arg1, this->arg2);
-    }
-};
+}
 
+// Клиент-сопрограмма: отправляет задачи по одной и ждёт каждую через co_await
 template <typename T>
-class Server {
-private:
-    struct task_with_id {
-        Task<T>* task;
-        size_t id;
-    };
-    std::condition_variable server_check; // Условная переменная для проверки состояния сервера
-    std::condition_variable client_check; // Условная переменная для проверки состояния клиента
-    size_t num_of_workers = 1; // Количество рабочих потоков
-    safe_que<task_with_id> task_que; // Безопасная очередь задач
-    safe_que<size_t> free_ids; // Очередь свободных идентификаторов задач
-    size_t max_id = 0; // Максимальный идентификатор задачи
-    std::unordered_map<size_t, T> task_result; // Карта результатов задач
-    std::vector<std::thread> event_thread_pool; // Пул потоков для обработки задач
-    bool running = false; // Флаг, указывающий, работает ли сервер
-    bool stopped = true; // Флаг, указывающий, остановлен ли сервер
-    std::mutex server_lock; // Мьютекс для синхронизации доступа к серверу
-    std::mutex cv_client_lock; // Мьютекс для синхронизации доступа к клиентам
-
-    // Метод для обработки задач в потоках
-    void event_loop() {
-        while (running) {
-            std::unique_lock<std::mutex> locker(server_lock);
-            while (task_que.empty()) {
-                server_check.wait(locker);
-                if (!running)
-                    return;
-            }
-            locker.unlock();
-            task_with_id task_struct;
-            task_struct.id = -1;
-            server_lock.lock();
-            if (!task_que.empty())
-                task_struct = task_que.pop();
-            server_lock.unlock();
-            if (task_struct.id != -1) {
-                T return_value = task_struct.task->do_task();
-                cv_client_lock.lock();
-                task_result.insert(std::make_pair(task_struct.id, return_value));
-                client_check.notify_all();
-                cv_client_lock.unlock();
-            }
-        }
-    }
-    // Метод для получения свободного идентификатора задачи
-    size_t get_free_id() {
-        server_lock.lock();
-        if (free_ids.empty()) {
-            free_ids.push(max_id++);
-        }
-        size_t free_id = free_ids.pop();
-        server_lock.unlock();
-        return free_id;
-    }
-public:
-    ~Server() {
-        if (!stopped) {
-            this->stop();
-        }
-    }
-    // Метод для запуска сервера
-    void start(size_t num_of_workers = 1) {
-        running = true;
-        stopped = false;
-        for (int i = 0; i < num_of_workers; i++) {
-            event_thread_pool.push_back(std::thread(&Server::event_loop, this));
-        }
-    }
-    // Метод для остановки сервера
-    void stop() {
-        running = false;
-        stopped = true;
-        server_check.notify_all();
-        for (std::thread& event_thread : this->event_thread_pool) {
-            event_thread.join();
-        }
-    }
-    // Метод для добавления задачи на сервер
-    size_t add_task(Task<T>* task) {
-        size_t free_id = get_free_id();
-        task_with_id task_to_add = { task, free_id };
-        server_lock.lock();
-        task_que.push(std::move(task_to_add));
-        server_check.notify_one();
-        server_lock.unlock();
-        return task_to_add.id;
-    }
-    // Метод для запроса результата выполнения задачи по идентификатору
-    T request_result(size_t id) {
-        std::unique_lock<std::mutex> locker(cv_client_lock);
-        while (task_result.find(id) == task_result.end()) {
-            client_check.wait(locker);
-        }
-        T result = task_result.at(id);
-        server_lock.lock();
-        task_result.erase(id);
-        free_ids.push(id);
-        server_lock.unlock();
-        return result;
+client_coroutine coroutine_client(Server<T>* server, executor* where, Task<T>* task, int num_of_tasks, std::latch* done) {
+    for (int i = 0; i < num_of_tasks; i++) {
+        co_await server->submit(task, where);
     }
-};
+    done->count_down();
+}
 
-// Функция для передачи задач серверу и ожидания их выполнения
+// Клиент в отдельном потоке: то же самое, но поток блокируется в request_result
 template <typename T>
-void give_task_to_server(Server<T>* server, Task<T>* task, int num_of_tasks) {
-    std::vector<size_t> task_ids(num_of_tasks);
+void blocking_client(Server<T>* server, Task<T>* task, int num_of_tasks) {
     for (int i = 0; i < num_of_tasks; i++) {
-        task_ids[i] = server->add_task(task);
+        server->request_result(server->add_task(task));
     }
-    for (auto task_id : task_ids) {
-        T result = server->request_result(task_id);
+}
+
+// Сравнение num_of_clients клиентов-потоков и клиентов-сопрограмм на executor
+void compare_clients(int num_of_clients, int tasks_per_client, size_t executor_threads) {
+    SinTask<float> task(3.14 / 6);
+    {
+        Server<float> server;
+        server.start(10);
+        std::vector<std::thread> clients;
+        const auto start{ std::chrono::steady_clock::now() };
+        try {
+            for (int i = 0; i < num_of_clients; i++)
+                clients.push_back(std::thread(blocking_client<float>, &server, &task, tasks_per_client));
+        }
+        catch (const std::system_error& error) {
+            // Ограничение числа потоков в системе: сравниваются только созданные клиенты
+            std::cout << "thread-per-client: only " << clients.size() << " threads created (" << error.what() << ")\n";
+        }
+        for (auto& thread : clients)
+            thread.join();
+        const auto end{ std::chrono::steady_clock::now() };
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        server.stop();
+        std::cout << "thread-per-client, " << clients.size() << " clients: " << elapsed_seconds.count() << "\n";
+    }
+    {
+        Server<float> server;
+        executor pool;
+        server.start(10);
+        pool.start(executor_threads);
+        std::latch done(num_of_clients);
+        const auto start{ std::chrono::steady_clock::now() };
+        for (int i = 0; i < num_of_clients; i++)
+            coroutine_client<float>(&server, &pool, &task, tasks_per_client, &done);
+        done.wait();
+        const auto end{ std::chrono::steady_clock::now() };
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        pool.stop();
+        server.stop();
+        std::cout << "coroutines on " << executor_threads << " executor threads, " << num_of_clients << " clients: "
+                  << elapsed_seconds.count() << "\n";
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     Server<float> server;
     server.start(10);
     std::vector<Task<float>*> tasks = { new PowTask<float>(5.0f, 2.0f),
@@ -245,5 +137,25 @@ int main() {
     const auto end{ std::chrono::steady_clock::now() };
     const std::chrono::duration<double> elapsed_seconds{ end - start };
     std::cout << elapsed_seconds.count() << "\n";
+
+    // Трёхэтапные цепочки: ожидание каждого этапа клиентом против зависимостей на сервере
+    Server<float> pipeline_server;
+    pipeline_server.start(10);
+    const auto blocking_start{ std::chrono::steady_clock::now() };
+    give_pipeline_blocking<float>(&pipeline_server, 10000);
+    const auto blocking_end{ std::chrono::steady_clock::now() };
+    give_pipeline_to_server<float>(&pipeline_server, 10000);
+    const auto dag_end{ std::chrono::steady_clock::now() };
+    pipeline_server.stop();
+    const std::chrono::duration<double> blocking_seconds{ blocking_end - blocking_start };
+    const std::chrono::duration<double> dag_seconds{ dag_end - blocking_end };
+    std::cout << "pipeline (client waits each stage): " << blocking_seconds.count() << "\n";
+    std::cout << "pipeline (task dependencies): " << dag_seconds.count() << "\n";
+
+    // ./task "Количество клиентов" "Задач на клиента" "Потоков executor"
+    int num_of_clients = argc > 1 ? std::stoi(argv[1]) : 10000;
+    int tasks_per_client = argc > 2 ? std::stoi(argv[2]) : 10;
+    size_t executor_threads = argc > 3 ? std::stoi(argv[3]) : 4;
+    compare_clients(num_of_clients, tasks_per_client, executor_threads);
     return 0;
 }
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include "../common/repro_sum.h"
 
 constexpr long long mult = 10000000;
 
@@ -12,11 +13,14 @@ typedef float DataType;
 
 int main() {
     std::vector<DataType> sins(mult);
-    DataType sum = 0;
-    for (long long i = 0; i < mult; ++i) {
+    for (long long i = 0; i < mult; ++i)
         sins[i] = std::sin(static_cast<DataType>(i) * 2 * M_PI / mult);
-        sum += sins[i];
-    }
+    // Воспроизводимая компенсированная сумма вместо последовательного накопления в DataType
+#ifdef USE_DOUBLE
+    DataType sum = repro_sum(sins.data(), sins.size());
+#else
+    DataType sum = repro_sumf(sins.data(), sins.size());
+#endif
     std::cout << "Sum: " << sum << std::endl;
     return 0;
 }
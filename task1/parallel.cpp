@@ -0,0 +1,112 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <omp.h>
+#include "../common/repro_sum.h"
+
+constexpr long long mult = 10000000;
+
+#ifdef USE_DOUBLE
+typedef double DataType;
+#else
+typedef float DataType;
+#endif
+
+// Количество независимых цепочек рекуррентности (ширина SIMD-блока)
+constexpr int lanes = 16;
+// Через сколько элементов рекуррентность заново привязывается к точным sin/cos
+constexpr long long anchor_block = 1024;
+
+// Синусы элементов [begin, end) поворотом: sin(x + d) = sin(x)cos(d) + cos(x)sin(d).
+// Цепочка l обрабатывает элементы begin + l, begin + l + lanes, ..., все цепочки поворачиваются
+// на lanes шагов сразу, поэтому внутренний цикл векторизуется. Если out == nullptr, значения
+// только суммируются без сохранения. Поворот и накопление ведутся в double даже для float:
+// cos шага поворота в float округляется до единицы, и ошибка рекуррентности быстро накапливается.
+double sin_block(long long begin, long long end, DataType* out) {
+    const double step = 2 * M_PI / mult;
+    const double rot_cos = std::cos(step * lanes);
+    const double rot_sin = std::sin(step * lanes);
+    double s[lanes], c[lanes], acc[lanes];
+    for (int l = 0; l < lanes; l++) {
+        s[l] = std::sin(step * (begin + l));
+        c[l] = std::cos(step * (begin + l));
+        acc[l] = 0;
+    }
+    long long full = begin + (end - begin) / lanes * lanes;
+    for (long long i = begin; i < full; i += lanes) {
+        #pragma omp simd
+        for (int l = 0; l < lanes; l++) {
+            if (out)
+                out[i + l] = s[l];
+            acc[l] += s[l];
+            double s_next = s[l] * rot_cos + c[l] * rot_sin;
+            c[l] = c[l] * rot_cos - s[l] * rot_sin;
+            s[l] = s_next;
+        }
+    }
+    // Хвост блока
+    for (long long i = full; i < end; i++) {
+        double value = std::sin(step * i);
+        if (out)
+            out[i] = value;
+        acc[0] += value;
+    }
+    double sum = 0;
+    for (int l = 0; l < lanes; l++)
+        sum += acc[l];
+    return sum;
+}
+
+// Генерация и суммирование по блокам между потоками. Суммы блоков складываются
+// фиксированным деревом, поэтому результат не зависит от числа потоков.
+DataType parallel_sum(DataType* out) {
+    long long blocks = (mult + anchor_block - 1) / anchor_block;
+    std::vector<double> partials(blocks);
+    #pragma omp parallel for schedule(static)
+    for (long long b = 0; b < blocks; b++)
+        partials[b] = sin_block(b * anchor_block, std::min(mult, (b + 1) * anchor_block), out);
+    return repro_tree_sum(partials.data(), blocks);
+}
+
+// Исходный последовательный вариант, относительно которого оценивается результат
+DataType serial_sum(std::vector<DataType>& sins) {
+    DataType sum = 0;
+    for (long long i = 0; i < mult; ++i) {
+        sins[i] = std::sin(static_cast<DataType>(i) * 2 * M_PI / mult);
+        sum += sins[i];
+    }
+    return sum;
+}
+
+template <typename Func>
+double measure(Func func) {
+    const auto start{std::chrono::steady_clock::now()};
+    func();
+    const auto end{std::chrono::steady_clock::now()};
+    const std::chrono::duration<double> elapsed_seconds{end - start};
+    return elapsed_seconds.count();
+}
+
+int main() {
+    std::vector<DataType> sins(mult);
+    DataType serial = 0, parallel = 0;
+    double serial_time = measure([&] { serial = serial_sum(sins); });
+
+#ifdef USE_STREAM
+    // Генерация слита с суммированием, массив не хранится
+    double parallel_time = measure([&] { parallel = parallel_sum(nullptr); });
+#else
+    double parallel_time = measure([&] { parallel = parallel_sum(sins.data()); });
+#endif
+
+    // Точная сумма синусов по полному периоду равна нулю
+    std::cout << "Threads: " << omp_get_max_threads() << "\n";
+    std::cout << "Serial sum: " << serial << " (" << serial_time << " s, " << mult / serial_time * 1e-6 << " M/s)\n";
+    std::cout << "Sum: " << parallel << " (" << parallel_time << " s, " << mult / parallel_time * 1e-6 << " M/s)\n";
+    std::cout << "Speedup: " << serial_time / parallel_time << "\n";
+    std::cout << "Error vs exact: serial " << std::fabs(serial) << ", parallel " << std::fabs(parallel) << "\n";
+    std::cout << "Difference from serial: " << std::fabs(parallel - serial) << "\n";
+    return 0;
+}
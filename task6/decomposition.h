@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <omp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Разбиение поля на полосы строк между несколькими локальными процессами.
+// Каждый процесс хранит свою полосу (плюс по одной строке гало сверху и снизу) в отдельной
+// странично-выровненной области разделяемой памяти и сам выполняет первое касание этой области,
+// поэтому при запуске с привязкой процессов к NUMA-узлам полоса оказывается в локальной памяти.
+// Обмен гало: граничные строки полосы считаются первыми и сразу записываются в гало соседей,
+// после чего считается внутренняя часть полосы, так что копирование перекрывается с вычислениями.
+// Глобальная ошибка собирается как максимум по всем процессам (all-reduce через разделяемую память).
+
+// Описание полосы одного процесса
+struct shm_band {
+    int first_row; // Первая строка полосы в глобальной нумерации
+    int rows; // Количество строк полосы (без гало)
+    size_t offset[2]; // Смещения двух буферов (текущий и следующий шаг) от начала разделяемой памяти
+};
+
+// Управляющий блок в начале разделяемой памяти
+struct shm_control {
+    pthread_barrier_t barrier; // Межпроцессный барьер, один на итерацию
+    int iterations; // Результат процесса с нулевой полосой
+    double error;
+};
+
+class shm_decomposition {
+public:
+    // threads_per_process - размер команды OpenMP в каждом процессе; 0 - ядра делятся поровну между процессами,
+    // чтобы N процессов не запускали по потоку на каждое ядро каждый
+    shm_decomposition(int size, int num_processes, int threads_per_process = 0)
+        : _size(size), _num_processes(num_processes),
+          _threads(threads_per_process > 0 ? threads_per_process : std::max(1, omp_get_num_procs() / std::max(1, num_processes))) {
+        int inner_rows = size - 2;
+        if (num_processes < 1 || num_processes > inner_rows)
+            throw std::invalid_argument("number of processes must be in [1, size]");
+
+        size_t page = sysconf(_SC_PAGESIZE);
+        auto align = [page](size_t bytes) { return (bytes + page - 1) / page * page; };
+
+        // Управляющий блок и массив ошибок: по одному значению на процесс для чётных и нечётных итераций
+        size_t offset = align(sizeof(shm_control) + 2 * num_processes * sizeof(double));
+        int last_row = 1;
+        for (int p = 0; p < num_processes; p++) {
+            shm_band band;
+            band.first_row = last_row;
+            band.rows = inner_rows / num_processes + (p < inner_rows % num_processes);
+            for (int k = 0; k < 2; k++) {
+                band.offset[k] = offset;
+                offset += align(static_cast<size_t>(band.rows + 2) * size * sizeof(double));
+            }
+            last_row += band.rows;
+            _bands.push_back(band);
+        }
+        _bytes = offset;
+
+        _base = static_cast<char*>(mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+        if (_base == MAP_FAILED)
+            throw std::runtime_error("mmap of shared field failed");
+
+        pthread_barrierattr_t attr;
+        pthread_barrierattr_init(&attr);
+        pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_barrier_init(&control()->barrier, &attr, num_processes);
+        pthread_barrierattr_destroy(&attr);
+    }
+
+    shm_decomposition(const shm_decomposition&) = delete;
+    shm_decomposition& operator=(const shm_decomposition&) = delete;
+
+    ~shm_decomposition() {
+        pthread_barrier_destroy(&control()->barrier);
+        munmap(_base, _bytes);
+    }
+
+    // Решение до заданной точности: порождает по процессу на полосу, ждёт их завершения и собирает поле в field.
+    // Должна вызываться до первого параллельного региона OpenMP в родительском процессе:
+    // libgomp не переживает fork после создания пула потоков.
+    // Если процесс не удалось создать или один из процессов завершился с ошибкой, остальные ждали бы его
+    // на барьере вечно, поэтому они принудительно завершаются, а run бросает исключение.
+    void run(const std::vector<std::tuple<int64_t, double>>& heat_points, double max_error, int max_iterations, std::vector<double>& field) {
+        std::vector<pid_t> children;
+        for (int p = 0; p < _num_processes; p++) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                kill_children(children);
+                throw std::runtime_error("fork failed");
+            }
+            if (pid == 0) {
+                int status = 0;
+                try {
+                    int it = solve(p, heat_points, max_error, max_iterations);
+                    if (p == 0) {
+                        control()->iterations = it;
+                        control()->error = _error;
+                    }
+                }
+                catch (...) {
+                    status = 1;
+                }
+                _exit(status);
+            }
+            children.push_back(pid);
+        }
+        if (!wait_children(children))
+            throw std::runtime_error("decomposition process failed");
+        int it = control()->iterations;
+        _iterations = it;
+        _error = control()->error;
+
+        // Сборка полос в общее поле
+        field.assign(static_cast<size_t>(_size) * _size, 0.0);
+        for (const shm_band& band : _bands) {
+            const double* src = buffer(band, it % 2);
+            std::memcpy(&field[static_cast<size_t>(band.first_row) * _size], src + _size, static_cast<size_t>(band.rows) * _size * sizeof(double));
+        }
+
+        std::cout << "num of iterations: " << it << "\n";
+        std::cout << "error: " << _error << "\n";
+        std::cout << "processes: " << _num_processes << "\n";
+    }
+
+    int iterations() const { return _iterations; }
+
+    double error() const { return _error; }
+
+private:
+    shm_control* control() { return reinterpret_cast<shm_control*>(_base); }
+
+    double* errors(int parity) { return reinterpret_cast<double*>(_base + sizeof(shm_control)) + parity * _num_processes; }
+
+    double* buffer(const shm_band& band, int parity) { return reinterpret_cast<double*>(_base + band.offset[parity]); }
+
+    // Пересчёт одной строки полосы (local_row в локальной нумерации, 1..rows); возвращает максимум изменения
+    double calculate_row(const double* in, double* out, int local_row, int global_row) {
+        int size = _size;
+        double err = 0;
+        for (int j = 1; j < size - 1; j++) {
+            int num_of_points = 1;
+            num_of_points += global_row > 1 ? 1 : 0;
+            num_of_points += j > 1 ? 1 : 0;
+            num_of_points += global_row < size - 2 ? 1 : 0;
+            num_of_points += j < size - 2 ? 1 : 0;
+            size_t idx = static_cast<size_t>(local_row) * size + j;
+            out[idx] = (in[idx - size] + in[idx - 1] + in[idx + size] + in[idx + 1] + in[idx]) * (1 / (float)num_of_points);
+            err = fmax(err, fabs(out[idx] - in[idx]));
+        }
+        return err;
+    }
+
+    // Вычисления одного процесса; возвращает число выполненных итераций
+    int solve(int rank, const std::vector<std::tuple<int64_t, double>>& heat_points, double max_error, int max_iterations) {
+        const shm_band& band = _bands[rank];
+        omp_set_num_threads(_threads);
+        size_t band_elems = static_cast<size_t>(band.rows + 2) * _size;
+        size_t row_bytes = _size * sizeof(double);
+
+        // Первое касание своей полосы этим процессом
+        for (int k = 0; k < 2; k++)
+            std::memset(buffer(band, k), 0, band_elems * sizeof(double));
+
+        // Начальные значения, включая строки гало
+        for (const auto& heat_point : heat_points) {
+            int64_t row = std::get<0>(heat_point) / _size;
+            int64_t col = std::get<0>(heat_point) % _size;
+            int64_t local_row = row - band.first_row + 1;
+            if (local_row >= 0 && local_row <= band.rows + 1) {
+                for (int k = 0; k < 2; k++)
+                    buffer(band, k)[static_cast<size_t>(local_row) * _size + col] = std::get<1>(heat_point);
+            }
+        }
+        pthread_barrier_wait(&control()->barrier);
+
+        const shm_band* upper = rank > 0 ? &_bands[rank - 1] : nullptr;
+        const shm_band* lower = rank < _num_processes - 1 ? &_bands[rank + 1] : nullptr;
+        double error = 1;
+        int it = 0;
+        while (error > max_error && it < max_iterations) {
+            int cur = it % 2, next = (it + 1) % 2;
+            double* in = buffer(band, cur);
+            double* out = buffer(band, next);
+
+            // Граничные строки полосы и их отправка в гало соседей
+            double err = calculate_row(in, out, 1, band.first_row);
+            if (band.rows > 1)
+                err = fmax(err, calculate_row(in, out, band.rows, band.first_row + band.rows - 1));
+            if (upper)
+                std::memcpy(buffer(*upper, next) + static_cast<size_t>(upper->rows + 1) * _size, out + _size, row_bytes);
+            if (lower)
+                std::memcpy(buffer(*lower, next), out + static_cast<size_t>(band.rows) * _size, row_bytes);
+
+            // Внутренние строки полосы
+            #pragma omp parallel for reduction(max:err)
+            for (int i = 2; i < band.rows; i++)
+                err = fmax(err, calculate_row(in, out, i, band.first_row + i - 1));
+
+            // All-reduce ошибки: каждый процесс пишет свою ошибку и после барьера берёт максимум
+            errors(cur)[rank] = err;
+            pthread_barrier_wait(&control()->barrier);
+            error = *std::max_element(errors(cur), errors(cur) + _num_processes);
+            it++;
+        }
+        _error = error;
+        return it;
+    }
+
+    // Ожидание всех процессов; при первом аварийном завершении остальные убиваются. false - был сбой
+    static bool wait_children(std::vector<pid_t>& children) {
+        bool ok = true;
+        size_t running = children.size();
+        while (running > 0) {
+            int status = 0;
+            pid_t pid = waitpid(-1, &status, 0);
+            if (pid < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            auto child = std::find(children.begin(), children.end(), pid);
+            if (child == children.end())
+                continue;
+            *child = -1;
+            running--;
+            if (ok && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+                ok = false;
+                if (WIFSIGNALED(status))
+                    std::cerr << "process " << pid << " killed by signal " << WTERMSIG(status) << "\n";
+                else
+                    std::cerr << "process " << pid << " exited with status " << WEXITSTATUS(status) << "\n";
+                for (pid_t other : children)
+                    if (other > 0)
+                        kill(other, SIGKILL);
+            }
+        }
+        return ok;
+    }
+
+    static void kill_children(const std::vector<pid_t>& children) {
+        for (pid_t pid : children)
+            kill(pid, SIGKILL);
+        for (pid_t pid : children)
+            waitpid(pid, nullptr, 0);
+    }
+
+    int _size;
+    int _num_processes;
+    int _threads; // Потоков OpenMP в каждом процессе
+    std::vector<shm_band> _bands;
+    char* _base{nullptr};
+    size_t _bytes{0};
+    int _iterations{0};
+    double _error{0};
+};
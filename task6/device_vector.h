@@ -1,41 +1,132 @@
 #include <cstddef>
+#include <map>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+
+// Пул выровненных буферов на хосте. Буферы размером от 2 МБ выравниваются по 2 МБ и помечаются
+// для прозрачных огромных страниц, меньшие - по строке кэша. Освобождённые буферы не отдаются
+// системе, а переиспользуются следующими векторами того же размера (например, между запусками решателя).
+class host_pool {
+public:
+  static constexpr size_t cache_line = 64;
+  static constexpr size_t huge_page = size_t(2) << 20;
+
+  static host_pool &instance() {
+    static host_pool pool;
+    return pool;
+  }
+
+  static size_t alignment(size_t bytes) { return bytes >= huge_page ? huge_page : cache_line; }
+
+  static size_t rounded(size_t bytes) {
+    size_t align = alignment(bytes);
+    return (bytes + align - 1) / align * align;
+  }
+
+  void *acquire(size_t bytes) {
+    bytes = rounded(bytes);
+    {
+      std::lock_guard<std::mutex> locker(_lock);
+      auto it = _free.find(bytes);
+      if (it != _free.end() && !it->second.empty()) {
+        void *ptr = it->second.back();
+        it->second.pop_back();
+        return ptr;
+      }
+    }
+    void *ptr = ::operator new(bytes, std::align_val_t(alignment(bytes)));
+    if (bytes >= huge_page)
+      madvise(ptr, bytes, MADV_HUGEPAGE);
+    return ptr;
+  }
+
+  void release(void *ptr, size_t bytes) {
+    std::lock_guard<std::mutex> locker(_lock);
+    _free[rounded(bytes)].push_back(ptr);
+  }
+
+  // Возврат всех свободных буферов системе
+  void trim() {
+    std::lock_guard<std::mutex> locker(_lock);
+    for (auto &bucket : _free)
+      for (void *ptr : bucket.second)
+        ::operator delete(ptr, std::align_val_t(alignment(bucket.first)));
+    _free.clear();
+  }
+
+  ~host_pool() { trim(); }
+
+private:
+  host_pool() = default;
+
+  std::mutex _lock;
+  std::map<size_t, std::vector<void *>> _free; // Свободные буферы по размеру
+};
 
 // clang-format off
 template <typename T> class device_vector {
 public:
   device_vector() = default;
 
-  explicit device_vector(size_t size) {
-    _size = size;
-    _A = new T[_size];
-    memset(_A, 0, size * sizeof(T));
-    #pragma acc enter data copyin(this) create(_A[0:_size])
-  }
+  explicit device_vector(size_t size) : device_vector(size, T()) {}
 
   explicit device_vector(size_t size, const T &value) {
     _size = size;
-    _A = new T[_size];
-    memset(_A, 0, size * sizeof(T));
-    for (int i = 0; i < _size; ++i) {
+    _A = static_cast<T *>(host_pool::instance().acquire(_size * sizeof(T)));
+    // Параллельное первое касание: страницы размещаются рядом с потоками, которые затем их обрабатывают.
+    // Заполняет тот же рантайм, что считает: в сборках OpenACC (и -acc=multicore) цикл acc, иначе OpenMP
+#ifdef _OPENACC
+    #pragma acc enter data copyin(this) create(_A[0:_size])
+    #pragma acc parallel loop present(_A[0:_size])
+    for (size_t i = 0; i < _size; ++i) {
       _A[i] = value;
     }
-    #pragma acc enter data copyin(this, _A[0:_size])
+    #pragma acc update self(_A[0:_size])
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < _size; ++i) {
+      _A[i] = value;
+    }
+#endif
   }
 
-  ~device_vector() {
-    #pragma acc exit data delete (this, _A[0:_size])
-    //delete[] _A;
-    _A = nullptr;
-    _size = 0;
+  // Копирование запрещено: копия разделяла бы буфер с оригиналом
+  device_vector(const device_vector &) = delete;
+  device_vector &operator=(const device_vector &) = delete;
+
+  // При перемещении буфер на устройстве не копируется: новый объект отображается на устройство
+  // и его указатель _A привязывается (attach) к уже присутствующим данным. Отображение самого
+  // объекта (this) у источника остаётся и удаляется в его release()
+  device_vector(device_vector &&other) noexcept : _A(other._A), _size(other._size) {
+    other._A = nullptr;
+    other._size = 0;
+    map_to_device();
   }
 
+  device_vector &operator=(device_vector &&other) noexcept {
+    if (this != &other) {
+      release();
+      _A = other._A;
+      _size = other._size;
+      other._A = nullptr;
+      other._size = 0;
+      map_to_device();
+    }
+    return *this;
+  }
+
+  ~device_vector() { release(); }
+
   void update_host(int start, int end) {
     #pragma acc update self(_A[start:end])
   }
 
   void update_host_async(int start, int end, int block) {
     #pragma acc update self(_A[start:end]) async(block)
-  } 
+  }
 
   void update_device(int start, int end) {
     #pragma acc update device(_A[start:end])
@@ -50,7 +141,28 @@ public:
   #pragma acc routine seq
   size_t size() const { return _size; }
 
+private:
+  void map_to_device() {
+    #pragma acc enter data copyin(this)
+    if (_A != nullptr) {
+      #pragma acc enter data attach(_A)
+    }
+  }
+
+  // Удаляет отображение объекта с устройства и в пустом состоянии (после перемещения из него);
+  // для объекта, созданного конструктором по умолчанию, delete отсутствующих данных ничего не делает
+  void release() {
+    if (_A == nullptr) {
+      #pragma acc exit data delete (this)
+      return;
+    }
+    #pragma acc exit data delete (this, _A[0:_size])
+    host_pool::instance().release(_A, _size * sizeof(T));
+    _A = nullptr;
+    _size = 0;
+  }
+
 public:
   T *_A{nullptr};
   size_t _size{0};
-};
\ No newline at end of file
+};
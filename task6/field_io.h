@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Бинарный формат теплового поля: заголовок фиксированного размера и следом
+// size*size значений double (вместе со строками и столбцами отступов).
+// Данные начинаются с границы страницы, поэтому файл можно напрямую отображать в память.
+
+constexpr char field_magic[8] = {'H', 'E', 'A', 'T', 'F', 'L', 'D', '1'};
+constexpr size_t field_data_offset = 4096; // Смещение данных от начала файла
+constexpr size_t field_io_batch = size_t(64) << 20; // Размер одной порции pwrite/pread в байтах
+
+struct field_header {
+    char magic[8];
+    int64_t size; // Размер поля вместе с отступами
+    int64_t iteration; // Номер итерации, на которой записано поле
+    double error; // Ошибка на этой итерации
+};
+
+// Запись/чтение буфера большими порциями с дозаписью при частичных операциях
+inline void pwrite_all(int fd, const void* data, size_t bytes, off_t offset) {
+    const char* ptr = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, ptr, std::min(bytes, field_io_batch), offset);
+        if (written <= 0)
+            throw std::runtime_error("pwrite failed");
+        ptr += written;
+        offset += written;
+        bytes -= written;
+    }
+}
+
+inline void pread_all(int fd, void* data, size_t bytes, off_t offset) {
+    char* ptr = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t was_read = pread(fd, ptr, std::min(bytes, field_io_batch), offset);
+        if (was_read <= 0)
+            throw std::runtime_error("pread failed");
+        ptr += was_read;
+        offset += was_read;
+        bytes -= was_read;
+    }
+}
+
+// Запись поля в файл. Сначала пишется временный файл, затем он переименовывается,
+// так что прерванная запись не портит предыдущую контрольную точку.
+inline void write_field(const std::string& path, const double* data, int64_t size, int64_t iteration, double error) {
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + tmp_path);
+    field_header header;
+    std::memcpy(header.magic, field_magic, sizeof(field_magic));
+    header.size = size;
+    header.iteration = iteration;
+    header.error = error;
+    try {
+        pwrite_all(fd, &header, sizeof(header), 0);
+        pwrite_all(fd, data, size * size * sizeof(double), field_data_offset);
+    }
+    catch (...) {
+        // Неполный временный файл не нужен, а дескриптор не должен теряться при повторных ошибках
+        close(fd);
+        std::remove(tmp_path.c_str());
+        throw;
+    }
+    close(fd);
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("cannot rename " + tmp_path);
+}
+
+inline field_header read_field_header(int fd) {
+    field_header header;
+    pread_all(fd, &header, sizeof(header), 0);
+    if (std::memcmp(header.magic, field_magic, sizeof(field_magic)) != 0)
+        throw std::runtime_error("not a heat field file");
+    return header;
+}
+
+// Чтение поля из файла в data (размер буфера должен быть не меньше size*size)
+inline field_header read_field(const std::string& path, double* data, int64_t max_size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+    field_header header = read_field_header(fd);
+    if (header.size > max_size) {
+        close(fd);
+        throw std::runtime_error("field in " + path + " is larger than the buffer");
+    }
+    pread_all(fd, data, header.size * header.size * sizeof(double), field_data_offset);
+    close(fd);
+    return header;
+}
+
+// Размер поля из заголовка файла (для выделения памяти перед чтением)
+inline int64_t field_file_size(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+    field_header header = read_field_header(fd);
+    close(fd);
+    return header.size;
+}
+
+// Фоновая запись контрольных точек. Вычислительный поток только копирует поле в снимок,
+// запись на диск выполняется отдельным потоком. Если предыдущая точка ещё пишется,
+// новый снимок ждёт её завершения, так что в памяти хранится не более одной копии поля.
+class checkpoint_writer {
+public:
+    explicit checkpoint_writer(std::string path) : _path(std::move(path)), _thread(&checkpoint_writer::loop, this) {}
+
+    checkpoint_writer(const checkpoint_writer&) = delete;
+    checkpoint_writer& operator=(const checkpoint_writer&) = delete;
+
+    ~checkpoint_writer() {
+        {
+            std::unique_lock<std::mutex> locker(_lock);
+            _cv.wait(locker, [this] { return !_pending; });
+            _running = false;
+        }
+        _cv.notify_all();
+        _thread.join();
+    }
+
+    void submit(const double* data, int64_t size, int64_t iteration, double error) {
+        std::unique_lock<std::mutex> locker(_lock);
+        _cv.wait(locker, [this] { return !_pending; });
+        _snapshot.assign(data, data + size * size);
+        _size = size;
+        _iteration = iteration;
+        _error = error;
+        _pending = true;
+        locker.unlock();
+        _cv.notify_all();
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> locker(_lock);
+        while (true) {
+            _cv.wait(locker, [this] { return _pending || !_running; });
+            if (!_pending)
+                return;
+            // Снимок не меняется, пока _pending установлен, поэтому запись идёт без блокировки.
+            // Ошибка записи (нет места, нет прав) не должна завершать программу: исключение из потока
+            // вызвало бы std::terminate, поэтому о ней сообщается, а расчёт продолжается
+            locker.unlock();
+            try {
+                write_field(_path, _snapshot.data(), _size, _iteration, _error);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "checkpoint at iteration " << _iteration << " failed: " << e.what() << "\n";
+            }
+            locker.lock();
+            _pending = false;
+            _cv.notify_all();
+        }
+    }
+
+    std::string _path;
+    std::vector<double> _snapshot;
+    int64_t _size{0};
+    int64_t _iteration{0};
+    double _error{0};
+    bool _pending{false};
+    bool _running{true};
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::thread _thread;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "field_io.h"
+
+// Решение для полей, не помещающихся в оперативную память.
+// Поле хранится в двух файлах формата field_io.h, отображённых в память; каждая итерация
+// читает один файл и пишет другой, проходя поле полосами строк. Для полос впереди текущей
+// выполняется madvise(MADV_WILLNEED), и ядро подкачивает их асинхронно, пока считается текущая полоса;
+// полосы позади окна освобождаются через MADV_DONTNEED, так что резидентными остаются только
+// несколько полос и объём памяти не зависит от размера поля.
+
+// Файл поля, отображённый в память
+class mapped_field {
+public:
+    // Создаёт файл с нулевым полем размера size x size
+    mapped_field(const std::string& path, int64_t size) : _path(path), _size(size) {
+        _fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (_fd < 0)
+            throw std::runtime_error("cannot open " + path);
+        _bytes = field_data_offset + size * size * sizeof(double);
+        if (ftruncate(_fd, _bytes) != 0) {
+            close(_fd);
+            throw std::runtime_error("cannot resize " + path);
+        }
+        _base = static_cast<char*>(mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0));
+        if (_base == MAP_FAILED) {
+            close(_fd);
+            throw std::runtime_error("cannot map " + path);
+        }
+        // Доступ последовательный по полосам
+        madvise(_base, _bytes, MADV_SEQUENTIAL);
+    }
+
+    mapped_field(const mapped_field&) = delete;
+    mapped_field& operator=(const mapped_field&) = delete;
+
+    ~mapped_field() {
+        munmap(_base, _bytes);
+        close(_fd);
+    }
+
+    double* data() { return reinterpret_cast<double*>(_base + field_data_offset); }
+
+    const std::string& path() const { return _path; }
+
+    // Подсказки ядру для строк [first_row, last_row); границы выравниваются по страницам
+    void advise(int64_t first_row, int64_t last_row, int advice) {
+        first_row = std::max<int64_t>(first_row, 0);
+        last_row = std::min<int64_t>(last_row, _size);
+        if (first_row >= last_row)
+            return;
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t begin = field_data_offset + first_row * _size * sizeof(double);
+        size_t end = field_data_offset + last_row * _size * sizeof(double);
+        begin = begin / page * page;
+        end = std::min((end + page - 1) / page * page, _bytes);
+        madvise(_base + begin, end - begin, advice);
+    }
+
+    void write_header(int64_t iteration, double error) {
+        field_header header;
+        std::memcpy(header.magic, field_magic, sizeof(field_magic));
+        header.size = _size;
+        header.iteration = iteration;
+        header.error = error;
+        std::memcpy(_base, &header, sizeof(header));
+    }
+
+    void sync() { msync(_base, _bytes, MS_SYNC); }
+
+private:
+    std::string _path;
+    int64_t _size;
+    int _fd{-1};
+    size_t _bytes{0};
+    char* _base{nullptr};
+};
+
+// Пересчёт полосы строк [first_row, last_row) пятиточечным шаблоном; возвращает максимум изменения
+inline double calculate_band(const double* matrix, double* matrix_out, int64_t size, int64_t first_row, int64_t last_row) {
+    double err = 0;
+    #pragma omp parallel for reduction(max:err)
+    for (int64_t i = first_row; i < last_row; i++) {
+        for (int64_t j = 1; j < size - 1; j++) {
+            int num_of_points = 1;
+            num_of_points += i > 1 ? 1 : 0;
+            num_of_points += j > 1 ? 1 : 0;
+            num_of_points += i < size - 2 ? 1 : 0;
+            num_of_points += j < size - 2 ? 1 : 0;
+            int64_t idx = i * size + j;
+            matrix_out[idx] = (matrix[idx - size] + matrix[idx - 1] + matrix[idx + size] + matrix[idx + 1] + matrix[idx]) * (1 / (float)num_of_points);
+            err = fmax(err, fabs(matrix_out[idx] - matrix[idx]));
+        }
+    }
+    return err;
+}
+
+// Вычисление теплового поля в файле path до заданной точности или максимального количества итераций.
+// band_rows - высота полосы, window - сколько полос впереди подкачивается заранее.
+// Итоговое поле остаётся в path (промежуточный файл path.next удаляется).
+inline void calculate_heatfield_out_of_core(const std::string& path, int64_t size, const std::vector<std::tuple<int64_t, double>>& heat_points,
+                                            double max_error, int max_iterations, int64_t band_rows, int window) {
+    mapped_field fields[2] = {mapped_field(path, size), mapped_field(path + ".next", size)};
+    for (auto heat_point : heat_points)
+        fields[0].data()[std::get<0>(heat_point)] = std::get<1>(heat_point);
+
+    band_rows = std::max<int64_t>(band_rows, 1);
+    double error = 1;
+    int it = 0;
+    while (error > max_error && it < max_iterations) {
+        mapped_field& in = fields[it % 2];
+        mapped_field& out = fields[(it + 1) % 2];
+        error = 0;
+        for (int64_t first_row = 1; first_row < size - 1; first_row += band_rows) {
+            int64_t last_row = std::min(first_row + band_rows, size - 1);
+            // Асинхронная подкачка полос впереди окна, пока считается текущая
+            in.advise(last_row, last_row + window * band_rows + 1, MADV_WILLNEED);
+            out.advise(last_row, last_row + window * band_rows, MADV_WILLNEED);
+            error = fmax(error, calculate_band(in.data(), out.data(), size, first_row, last_row));
+            // Строки позади окна больше не нужны на этой итерации (строка first_row - 1 ещё служит гало)
+            in.advise(0, first_row - 1, MADV_DONTNEED);
+            out.advise(0, first_row, MADV_DONTNEED);
+        }
+        it++;
+    }
+
+    // Результат последней итерации лежит в fields[it % 2]
+    mapped_field& result = fields[it % 2];
+    result.write_header(it, error);
+    result.sync();
+    if (&result != &fields[0])
+        std::rename(result.path().c_str(), path.c_str());
+    else
+        std::remove(fields[1].path().c_str());
+
+    std::cout << "num of iterations: " << it << "\n";
+    std::cout << "error: " << error << "\n";
+}
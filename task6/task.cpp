@@ -4,17 +4,31 @@
 #include <cmath>
 #include <string>
 #include <chrono>
+#include <memory>
 #include <omp.h>
 #include <boost/program_options.hpp>
+#ifdef USE_NVTX
 #include <nvtx3/nvToolsExt.h>
+#define range_push(name) nvtxRangePushA(name)
+#define range_pop() nvtxRangePop()
+#define range_work(name, flops, bytes)
+#else
+#include "../common/perf_region.h"
+#define range_push(name) perf::push(name)
+#define range_pop() perf::pop()
+#define range_work(name, flops, bytes) perf::add_work(name, flops, bytes)
+#endif
 #include "device_vector.h"
+#include "decomposition.h"
+#include "field_io.h"
+#include "out_of_core.h"
 
 #define OFFSET(x, y, m) (((x)*(m)) + (y)) // Макрос для вычисления смещения в матрице
 
 // Функция для инициализации теплового поля
-void initialize_field(device_vector<double>& matrix, std::vector<std::tuple<int, double>> heat_points) {
+void initialize_field(device_vector<double>& matrix, std::vector<std::tuple<int64_t, double>> heat_points) {
     for (auto heat_point : heat_points) {
-        int index = std::get<0>(heat_point); // Индекс точки нагрева
+        int64_t index = std::get<0>(heat_point); // Индекс точки нагрева
         double temp = std::get<1>(heat_point); // Температура в этой точке
         matrix[index] = temp; // Устанавливаем температуру в матрице
     }
@@ -22,7 +36,7 @@ void initialize_field(device_vector<double>& matrix, std::vector<std::tuple<int,
 }
 
 // Функция для вывода теплового поля
-void draw_field(device_vector<double> matrix, int size) {
+void draw_field(const device_vector<double>& matrix, int size) {
     for (int i = 1; i < size - 1; i++) { // Итерация по строкам матрицы
         for (int j = 1; j < size - 1; j++) // Итерация по столбцам матрицы
             std::cout << matrix[OFFSET(i, j, size)] << " "; // Вывод значения элемента
@@ -71,22 +85,32 @@ void copy_matrix(device_vector<double>& matrix, device_vector<double>& matrix_ou
     }
 }
 
-// Функция для вычисления теплового поля до заданной точности или максимального количества итераций
-void calculate_heatfield(device_vector<double>& matrix, device_vector<double>& matrix_out, int size, double max_error, int max_iterrations) {
-    double error = 1;
-    int it = 0;
-    nvtxRangePushA("while"); // Начало профилирования блока while
+// Функция для вычисления теплового поля до заданной точности или максимального количества итераций.
+// it и error задают начальное состояние (ненулевое при рестарте) и возвращают итоговое.
+// Если передан checkpoints, каждые checkpoint_every итераций поле отдаётся на фоновую запись.
+void calculate_heatfield(device_vector<double>& matrix, device_vector<double>& matrix_out, int size, double max_error, int max_iterrations,
+                         int& it, double& error, checkpoint_writer* checkpoints = nullptr, int checkpoint_every = 0) {
+    // Минимальный объём работы шага: 7 операций на внутреннюю точку, чтение старого и запись нового значения
+    const double inner_points = double(size - 2) * (size - 2);
+    range_push("while"); // Начало профилирования блока while
     while (error > max_error && it < max_iterrations) { // Условие завершения цикла
-        nvtxRangePushA("calc"); // Начало профилирования блока calc
+        range_push("calc"); // Начало профилирования блока calc
         error = calculate_step(matrix, matrix_out, size); // Вычисление одного шага
-        nvtxRangePop(); // Завершение профилирования блока calc
+        range_pop(); // Завершение профилирования блока calc
+        range_work("calc", 7 * inner_points, 2 * sizeof(double) * inner_points);
 
-        nvtxRangePushA("copy"); // Начало профилирования блока copy
+        range_push("copy"); // Начало профилирования блока copy
         copy_matrix(matrix, matrix_out, size); // Копирование матрицы
-        nvtxRangePop(); // Завершение профилирования блока copy
+        range_pop(); // Завершение профилирования блока copy
+        range_work("copy", 0, 2 * sizeof(double) * double(size) * size);
         it++;
+
+        // Контрольная точка: matrix_out актуальна на хосте после calculate_step
+        if (checkpoints && checkpoint_every > 0 && it % checkpoint_every == 0)
+            checkpoints->submit(matrix_out._A, size, it, error);
     }
-    
+    range_pop(); // Завершение профилирования блока while
+
     std::cout << "num of iterations: " << it << "\n";
     std::cout << "error: " << error << "\n";
 }
@@ -97,6 +121,12 @@ int main(int argc, char** argv) {
     int size = 10;
     double max_error = 1e-6;
     int max_iterations = 1000000;
+    int num_processes = 1;
+    int threads_per_process = 0;
+    int checkpoint_every = 0;
+    std::string output_file, checkpoint_file, restart_file, out_of_core_file;
+    int band_rows = 256;
+    int window = 4;
 
     // Инициализация парсера аргументов командной строки
     po::options_description desc("Allowed options");
@@ -105,40 +135,178 @@ int main(int argc, char** argv) {
                     ("size,s", po::value<int>(&size), "field size")
                     ("max_error,me", po::value<double>(&max_error), "max error of calculation")
                     ("max_iterations,mit", po::value<int>(&max_iterations), "max iteration count of calculation")
-                    ("draw_output,do", "Draw output matrix");
+                    ("processes,p", po::value<int>(&num_processes), "number of local processes for row decomposition")
+                    ("threads_per_process", po::value<int>(&threads_per_process), "OpenMP threads in each process (default: cores / processes)")
+                    ("draw_output,do", "Draw output matrix")
+                    ("profile", "report hardware counters and roofline for profiled regions")
+                    ("output", po::value<std::string>(&output_file), "write output field to binary file")
+                    ("checkpoint", po::value<std::string>(&checkpoint_file), "binary checkpoint file")
+                    ("checkpoint_every", po::value<int>(&checkpoint_every), "checkpoint period in iterations")
+                    ("restart,r", po::value<std::string>(&restart_file), "continue calculation from binary field file")
+                    ("out_of_core", po::value<std::string>(&out_of_core_file), "keep the field in a memory-mapped file (result stays in it)")
+                    ("band_rows", po::value<int>(&band_rows), "rows per band in out-of-core mode")
+                    ("window", po::value<int>(&window), "bands prefetched ahead in out-of-core mode");
     po::variables_map vm;
     po::store(po::command_line_parser (argc, argv).options(desc).allow_unregistered().run(), vm);
     po::notify(vm);
     if (vm.count("help")) {
-        std::cout << "-s - size\n-me - max error of calculation\n-mit - max iteration count of calculation\n";
+        std::cout << "-s - size\n-me - max error of calculation\n-mit - max iteration count of calculation\n-p - number of local processes\n--threads_per_process - OpenMP threads per process\n"
+                     "--output - output binary file\n--checkpoint - checkpoint file\n--checkpoint_every - checkpoint period\n-r - restart file\n"
+                     "--profile - hardware counter report\n--out_of_core - field file for out-of-core mode\n--band_rows - rows per band\n--window - bands prefetched ahead\n";
         return 0;
     }
 
-    // Создание и инициализация матриц
-    device_vector<double> matrix = device_vector<double>((size+2) * (size+2));
-    device_vector<double> matrix_out = device_vector<double>((size+2) * (size+2));
     size += 2; // Добавление отступов
+    // Контрольные точки и перезапуск есть только у расчёта в памяти одного процесса
+    bool checkpointing = !checkpoint_file.empty() || vm.count("checkpoint_every");
+    if (checkpointing && (checkpoint_file.empty() || checkpoint_every <= 0)) {
+        std::cout << "--checkpoint and a positive --checkpoint_every must be given together\n";
+        return 1;
+    }
+    if (num_processes > 1 && (checkpointing || !restart_file.empty() || !out_of_core_file.empty())) {
+        std::cout << "checkpoint, restart and out-of-core mode are not supported with several processes\n";
+        return 1;
+    }
+    if (!out_of_core_file.empty() && (checkpointing || !restart_file.empty())) {
+        std::cout << "checkpoint and restart are not supported in out-of-core mode\n";
+        return 1;
+    }
+    // В режиме вне памяти результат остаётся в файле --out_of_core
+    if (!out_of_core_file.empty() && (!output_file.empty() || vm.count("draw_output"))) {
+        std::cout << "--output and --draw_output are not supported in out-of-core mode\n";
+        return 1;
+    }
+    // Ошибки ввода-вывода полей (нет файла, нет прав, нет места) сообщаются, и программа завершается с кодом 1
+    if (!restart_file.empty()) {
+        try {
+            size = field_file_size(restart_file); // Размер поля берётся из файла
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
 
-    // Определение начальных точек нагрева
-    std::vector<std::tuple<int, double>> heat_points({std::make_tuple(size + 1, 10), 
-                                                    std::make_tuple(2 * (size) - 2 , 20), 
-                                                    std::make_tuple(size * size - 2 * (size) + 1, 30), 
-                                                    std::make_tuple(size * size - size - 2, 40)
+    // Определение начальных точек нагрева (индексы в 64 битах: size * size не помещается в int при size > 46340)
+    const int64_t side = size;
+    std::vector<std::tuple<int64_t, double>> heat_points({std::make_tuple(side + 1, 10.0), 
+                                                    std::make_tuple(2 * side - 2, 20.0), 
+                                                    std::make_tuple(side * side - 2 * side + 1, 30.0), 
+                                                    std::make_tuple(side * side - side - 2, 40.0)
                                                     }); // Инициализация точек с теплом
     
-    nvtxRangePushA("init"); // Начало профилирования блока init
-    initialize_field(matrix, heat_points); // Инициализация теплового поля
-    nvtxRangePop(); // Завершение профилирования блока init
+    // Разбиение поля между несколькими процессами (до создания матриц и любых параллельных регионов OpenMP)
+    if (num_processes > 1) {
+        std::cout << "size: " << size-2 << "x" << size-2 << '\n';
+        std::vector<double> field;
+        std::unique_ptr<shm_decomposition> decomposition;
+        const auto start{ std::chrono::steady_clock::now() };
+        try {
+            decomposition = std::make_unique<shm_decomposition>(size, num_processes, threads_per_process);
+            decomposition->run(heat_points, max_error, max_iterations, field);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        const auto end{ std::chrono::steady_clock::now() };
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << elapsed_seconds.count() << " s\n";
+        if (!output_file.empty()) {
+            try {
+                write_field(output_file, field.data(), size, decomposition->iterations(), decomposition->error());
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        }
+        if (vm.count("draw_output")) {
+            device_vector<double> matrix_out = device_vector<double>(size_t(size) * size);
+            std::copy(field.begin(), field.end(), matrix_out._A);
+            draw_field(matrix_out, size);
+        }
+        return 0;
+    }
+
+    // Поле в отображённом в память файле, обрабатываемое полосами
+    if (!out_of_core_file.empty()) {
+        std::cout << "size: " << size-2 << "x" << size-2 << '\n';
+        const auto start{ std::chrono::steady_clock::now() };
+        try {
+            calculate_heatfield_out_of_core(out_of_core_file, size, heat_points, max_error, max_iterations, band_rows, window);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        const auto end{ std::chrono::steady_clock::now() };
+        const std::chrono::duration<double> elapsed_seconds{ end - start };
+        std::cout << elapsed_seconds.count() << " s\n";
+        return 0;
+    }
+
+    // Создание и инициализация матриц
+    device_vector<double> matrix = device_vector<double>(size_t(size) * size);
+    device_vector<double> matrix_out = device_vector<double>(size_t(size) * size);
+
+#ifndef USE_NVTX
+    perf::enable(vm.count("profile") > 0);
+#endif
+
+    int it = 0;
+    double error = 1;
+    range_push("init"); // Начало профилирования блока init
+    if (restart_file.empty()) {
+        initialize_field(matrix, heat_points); // Инициализация теплового поля
+    }
+    else {
+        // Загрузка поля из контрольной точки в обе матрицы
+        field_header header;
+        try {
+            header = read_field(restart_file, matrix._A, size);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        std::copy(matrix._A, matrix._A + matrix.size(), matrix_out._A);
+        matrix.update_device(0, matrix.size());
+        matrix_out.update_device(0, matrix_out.size());
+        it = header.iteration;
+        error = header.error;
+        std::cout << "restart from iteration " << it << "\n";
+    }
+    range_pop(); // Завершение профилирования блока init
     
     std::cout << "size: " << size-2 << "x" << size-2 << '\n';
 
     // Начало измерения времени
     const auto start{ std::chrono::steady_clock::now() };
-    calculate_heatfield(matrix, matrix_out, size, max_error, max_iterations);
+    {
+        std::unique_ptr<checkpoint_writer> checkpoints;
+        if (checkpointing)
+            checkpoints = std::make_unique<checkpoint_writer>(checkpoint_file);
+        calculate_heatfield(matrix, matrix_out, size, max_error, max_iterations, it, error, checkpoints.get(), checkpoint_every);
+    }
     const auto end{ std::chrono::steady_clock::now() };
     const std::chrono::duration<double> elapsed_seconds{ end - start };
     std::cout << elapsed_seconds.count() << " s\n";
 
+    if (!output_file.empty()) {
+        try {
+            write_field(output_file, matrix_out._A, size, it, error);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+#ifndef USE_NVTX
+    perf::report(std::cout);
+#endif
+
     // Если флаг вывода установлен, выводим конечную матрицу
     if (vm.count("draw_output")) {
         draw_field(matrix_out, size);